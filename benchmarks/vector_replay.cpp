@@ -0,0 +1,251 @@
+// Replays an np::vector operation trace (see containers/vector/trace.hpp) against np::vector with
+// different allocators and growth policies and against std::vector, and reports the time,
+// allocation count and peak live memory of each.
+//
+//     vector_replay <trace> [--element-size 8|64] [--repeat N]
+//
+// Element values are not part of a trace; every element is a zero-initialized payload of the
+// chosen size. Growth policies other than np::vector's native doubling are emulated by reserving
+// ahead of each push_back/insert that would otherwise reallocate.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../containers/vector/trace.hpp"
+#include "../containers/vector/vector.hpp"
+
+namespace {
+    struct allocation_stats {
+        std::uint64_t allocations = 0;
+        std::uint64_t bytes_allocated = 0;
+        std::uint64_t live_bytes = 0;
+        std::uint64_t peak_bytes = 0;
+    };
+
+    allocation_stats stats;
+
+    template <typename T, typename Base = std::allocator<T>>
+    struct counting_allocator {
+        using value_type = T;
+        using base_traits = std::allocator_traits<Base>;
+
+        template <typename U>
+        struct rebind {
+            using other = counting_allocator<U, typename base_traits::template rebind_alloc<U>>;
+        };
+
+        Base base_;
+
+        counting_allocator() = default;
+
+        template <typename U, typename OtherBase>
+        counting_allocator(const counting_allocator<U, OtherBase>&) noexcept {}
+
+        T* allocate(const std::size_t n) {
+            const std::uint64_t bytes = n * sizeof(T);
+            ++stats.allocations;
+            stats.bytes_allocated += bytes;
+            stats.live_bytes += bytes;
+            stats.peak_bytes = std::max(stats.peak_bytes, stats.live_bytes);
+
+            return base_traits::allocate(base_, n);
+        }
+
+        void deallocate(T* ptr, const std::size_t n) noexcept {
+            stats.live_bytes -= n * sizeof(T);
+            base_traits::deallocate(base_, ptr, n);
+        }
+
+        template <typename U, typename OtherBase>
+        bool operator==(const counting_allocator<U, OtherBase>&) const noexcept {
+            return true;
+        }
+    };
+
+    template <std::size_t Bytes>
+    struct payload {
+        std::array<unsigned char, Bytes> bytes{};
+    };
+
+    struct result {
+        double milliseconds = 0;
+        allocation_stats allocations;
+    };
+
+    template <typename Container>
+    void grow_ahead(Container& container, const double growth_factor) {
+        if (growth_factor > 0 && container.size() == container.capacity()) {
+            const auto capacity = container.capacity();
+            container.reserve(std::max<std::size_t>(capacity + 1, static_cast<std::size_t>(static_cast<double>(capacity) * growth_factor)));
+        }
+    }
+
+    template <typename Container>
+    void replay_once(const np::vector<np::trace::event>& events, const double growth_factor) {
+        using value_type = typename Container::value_type;
+
+        std::unordered_map<std::uint64_t, Container> live;
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            const np::trace::event& record = events[i];
+            if (record.type == np::trace::op::destroy) {
+                live.erase(record.vector_id);
+                continue;
+            }
+
+            Container& container = live[record.vector_id];
+            const std::size_t size = container.size();
+            switch (record.type) {
+                case np::trace::op::push_back:
+                    grow_ahead(container, growth_factor);
+                    container.push_back(value_type{});
+                    break;
+                case np::trace::op::pop_back:
+                    if (size != 0) {
+                        container.pop_back();
+                    }
+                    break;
+                case np::trace::op::insert: {
+                    grow_ahead(container, growth_factor);
+                    const std::size_t position = std::min<std::size_t>(record.first, size);
+                    container.insert(container.begin() + position, value_type{});
+                    break;
+                }
+                case np::trace::op::erase: {
+                    const std::size_t position = std::min<std::size_t>(record.first, size);
+                    const std::size_t count = std::min<std::size_t>(record.second, size - position);
+                    if (count != 0) {
+                        container.erase(container.begin() + position, container.begin() + position + count);
+                    }
+                    break;
+                }
+                case np::trace::op::reserve:
+                    container.reserve(record.first);
+                    break;
+                case np::trace::op::resize:
+                    container.resize(record.first);
+                    break;
+                case np::trace::op::clear:
+                    container.clear();
+                    break;
+                case np::trace::op::shrink_to_fit:
+                    container.shrink_to_fit();
+                    break;
+                case np::trace::op::destroy:
+                    break;
+            }
+        }
+    }
+
+    template <typename Container>
+    result replay(const np::vector<np::trace::event>& events, const double growth_factor, const int repeat) {
+        result best;
+        for (int run = 0; run < repeat; ++run) {
+            stats = allocation_stats{};
+
+            const auto start = std::chrono::steady_clock::now();
+            replay_once<Container>(events, growth_factor);
+            const auto stop = std::chrono::steady_clock::now();
+
+            const double milliseconds = std::chrono::duration<double, std::milli>(stop - start).count();
+            if (run == 0 || milliseconds < best.milliseconds) {
+                best.milliseconds = milliseconds;
+                best.allocations = stats;
+            }
+        }
+
+        return best;
+    }
+
+    void print(const char* name, const result& measured) {
+        std::printf("%-34s %10.3f %12llu %14llu %14llu\n",
+                    name,
+                    measured.milliseconds,
+                    static_cast<unsigned long long>(measured.allocations.allocations),
+                    static_cast<unsigned long long>(measured.allocations.bytes_allocated),
+                    static_cast<unsigned long long>(measured.allocations.peak_bytes));
+    }
+
+    template <std::size_t Bytes>
+    void run_all(const np::vector<np::trace::event>& events, const int repeat) {
+        using value_type = payload<Bytes>;
+        using np_default = np::vector<value_type, counting_allocator<value_type>>;
+        using np_aligned = np::vector<value_type, counting_allocator<value_type, np::aligned_allocator<value_type, 64>>>;
+        using std_default = std::vector<value_type, counting_allocator<value_type>>;
+
+        std::printf("%-34s %10s %12s %14s %14s\n", "container", "time ms", "allocations", "bytes", "peak bytes");
+        print("np::vector (growth 2x)", replay<np_default>(events, 0, repeat));
+        print("np::vector (growth 1.5x)", replay<np_default>(events, 1.5, repeat));
+        print("np::vector (growth 4x)", replay<np_default>(events, 4, repeat));
+        print("np::vector aligned_allocator<64>", replay<np_aligned>(events, 0, repeat));
+        print("std::vector", replay<std_default>(events, 0, repeat));
+    }
+
+    int usage() {
+        std::cerr << "usage: vector_replay <trace> [--element-size 8|64] [--repeat N]\n";
+        return 2;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        return usage();
+    }
+
+    std::size_t element_size = 8;
+    int repeat = 3;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--element-size") == 0 && i + 1 < argc) {
+            element_size = std::stoul(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, std::stoi(argv[++i]));
+        }
+        else {
+            return usage();
+        }
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        std::cerr << "cannot open " << argv[1] << "\n";
+        return 1;
+    }
+
+    np::vector<np::trace::event> events;
+    try {
+        np::trace::reader trace(in);
+        np::trace::event record;
+        while (trace.next(record)) {
+            events.push_back(record);
+        }
+    }
+    catch (const std::exception& error) {
+        std::cerr << argv[1] << ": " << error.what() << "\n";
+        return 1;
+    }
+
+    std::printf("%zu events, %zu-byte elements, best of %d\n", events.size(), element_size, repeat);
+    switch (element_size) {
+        case 8:
+            run_all<8>(events, repeat);
+            break;
+        case 64:
+            run_all<64>(events, repeat);
+            break;
+        default:
+            return usage();
+    }
+
+    return 0;
+}
@@ -0,0 +1,509 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "../vector/exceptions.hpp"
+
+namespace np {
+    // Double-ended vector: one contiguous buffer with free capacity at both ends, so push_front and
+    // push_back are both amortized O(1). Insertions and erasures in the middle shift whichever side
+    // of the position is shorter. Elements stay contiguous, so data()/size() can back a std::span.
+    template <typename T, typename Allocator = std::allocator<T>>
+    class devector {
+    public:
+
+        // Allocator
+        using allocator_type = Allocator;
+        using allocator_traits = std::allocator_traits<allocator_type>;
+
+        // Type
+        using value_type = T;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = typename std::allocator_traits<allocator_type>::pointer;
+        using const_pointer = typename std::allocator_traits<allocator_type>::const_pointer;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        using iterator = value_type*;
+        using const_iterator = const value_type*;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    private:
+
+        size_type capacity_ = 0;
+        size_type front_ = 0;
+        size_type size_ = 0;
+
+        pointer data_ = nullptr;
+
+        allocator_type allocator_;
+
+        pointer first() const noexcept { return data_ + front_; }
+        pointer last() const noexcept { return data_ + front_ + size_; }
+
+        // Moves the elements into dst. On failure the moved-to prefix is destroyed and the elements
+        // stay where they are.
+        void relocate_into(const pointer dst) {
+            size_type index = 0;
+            NP_VECTOR_TRY {
+                for (; index < size_; ++index) {
+                    allocator_traits::construct(allocator_, dst + index, std::move_if_noexcept(first()[index]));
+                }
+            }
+            NP_VECTOR_CATCH(...) {
+                for (size_type i = 0; i < index; ++i) {
+                    allocator_traits::destroy(allocator_, dst + i);
+                }
+                NP_VECTOR_RETHROW;
+            }
+        }
+
+        void adopt(const pointer new_arr, const size_type new_capacity, const size_type new_front) noexcept {
+            destroy_and_deallocate();
+
+            data_ = new_arr;
+            capacity_ = new_capacity;
+            front_ = new_front;
+        }
+
+        // Moves the elements into a new buffer of new_capacity, starting new_front slots in.
+        void reallocate(const size_type new_capacity, const size_type new_front) {
+            pointer new_arr = allocator_traits::allocate(allocator_, new_capacity);
+
+            NP_VECTOR_TRY {
+                relocate_into(new_arr + new_front);
+            }
+            NP_VECTOR_CATCH(...) {
+                allocator_traits::deallocate(allocator_, new_arr, new_capacity);
+                NP_VECTOR_RETHROW;
+            }
+
+            adopt(new_arr, new_capacity, new_front);
+        }
+
+        void destroy_and_deallocate() noexcept {
+            if (data_ != nullptr) {
+                for (size_type i = 0; i < size_; ++i) {
+                    allocator_traits::destroy(allocator_, first() + i);
+                }
+
+                allocator_traits::deallocate(allocator_, data_, capacity_);
+            }
+        }
+
+        // Capacity and front gap after growing so that the requested end has a free slot. The slack is
+        // split between both ends, but the other end keeps no more than it already had, so one-ended
+        // growth behaves like a vector.
+        std::pair<size_type, size_type> grown_layout(const bool at_front) const noexcept {
+            const size_type new_capacity = std::max<size_type>(std::max<size_type>(capacity_ * 2, size_ + 1), 4);
+            const size_type slack = new_capacity - size_;
+
+            if (at_front) {
+                const size_type back_gap = std::min(back_free_capacity(), slack / 2);
+                return {new_capacity, slack - back_gap};
+            }
+            return {new_capacity, std::min(front_, slack / 2)};
+        }
+
+        void grow(const bool at_front) {
+            const auto [new_capacity, new_front] = grown_layout(at_front);
+            reallocate(new_capacity, new_front);
+        }
+
+        // Grows towards the requested end and constructs the new element there before the old ones
+        // move, so args may refer to elements of this devector.
+        template <typename... Args>
+        [[gnu::noinline]] void grow_and_emplace(const bool at_front, Args&&... args) {
+            const auto [new_capacity, new_front] = grown_layout(at_front);
+            pointer new_arr = allocator_traits::allocate(allocator_, new_capacity);
+            pointer slot = at_front ? new_arr + new_front - 1 : new_arr + new_front + size_;
+
+            NP_VECTOR_TRY {
+                allocator_traits::construct(allocator_, slot, std::forward<Args>(args)...);
+            }
+            NP_VECTOR_CATCH(...) {
+                allocator_traits::deallocate(allocator_, new_arr, new_capacity);
+                NP_VECTOR_RETHROW;
+            }
+
+            NP_VECTOR_TRY {
+                relocate_into(new_arr + new_front);
+            }
+            NP_VECTOR_CATCH(...) {
+                allocator_traits::destroy(allocator_, slot);
+                allocator_traits::deallocate(allocator_, new_arr, new_capacity);
+                NP_VECTOR_RETHROW;
+            }
+
+            adopt(new_arr, new_capacity, at_front ? new_front - 1 : new_front);
+            ++size_;
+        }
+
+        void ensure_front() {
+            if (front_ == 0) {
+                grow(true);
+            }
+        }
+
+        void ensure_back() {
+            if (back_free_capacity() == 0) {
+                grow(false);
+            }
+        }
+
+    public:
+        devector() = default;
+
+        explicit devector(const allocator_type& allocator) noexcept : allocator_(allocator) {}
+
+        explicit devector(const size_type n) : capacity_(n), size_(n), data_(allocator_traits::allocate(allocator_, n)) {
+            std::uninitialized_value_construct_n(std::to_address(data_), n);
+        }
+
+        devector(const size_type n, const_reference value) : capacity_(n), size_(n), data_(allocator_traits::allocate(allocator_, n)) {
+            std::uninitialized_fill_n(std::to_address(data_), n, value);
+        }
+
+        devector(const std::initializer_list<T>& list) : capacity_(list.size()), size_(list.size()), data_(allocator_traits::allocate(allocator_, capacity_)) {
+            std::uninitialized_copy(list.begin(), list.end(), std::to_address(data_));
+        }
+
+        devector(const devector& other) : allocator_(allocator_traits::select_on_container_copy_construction(other.allocator_)) {
+            if (other.size_ == 0) {
+                return;
+            }
+
+            pointer new_arr = allocator_traits::allocate(allocator_, other.size_);
+            NP_VECTOR_TRY {
+                std::uninitialized_copy(other.begin(), other.end(), std::to_address(new_arr));
+            }
+            NP_VECTOR_CATCH(...) {
+                allocator_traits::deallocate(allocator_, new_arr, other.size_);
+                NP_VECTOR_RETHROW;
+            }
+
+            data_ = new_arr;
+            capacity_ = other.size_;
+            size_ = other.size_;
+        }
+
+        devector(devector&& other) noexcept
+            : capacity_(std::exchange(other.capacity_, 0)),
+              front_(std::exchange(other.front_, 0)),
+              size_(std::exchange(other.size_, 0)),
+              data_(std::exchange(other.data_, nullptr)),
+              allocator_(std::move(other.allocator_)) {}
+
+        devector& operator=(const devector& other) {
+            if (this != &other) {
+                devector copy(other);
+                swap(copy);
+            }
+
+            return *this;
+        }
+
+        devector& operator=(devector&& other) noexcept(allocator_traits::propagate_on_container_move_assignment::value || allocator_traits::is_always_equal::value) {
+            if (this == &other) {
+                return *this;
+            }
+
+            if constexpr (!allocator_traits::propagate_on_container_move_assignment::value && !allocator_traits::is_always_equal::value) {
+                if (allocator_ != other.allocator_) {
+                    // The buffer can't change hands between unequal allocators, so move the elements
+                    // into one of ours.
+                    pointer new_arr = nullptr;
+                    if (other.size_ != 0) {
+                        new_arr = allocator_traits::allocate(allocator_, other.size_);
+                        size_type index = 0;
+                        NP_VECTOR_TRY {
+                            for (; index < other.size_; ++index) {
+                                allocator_traits::construct(allocator_, new_arr + index, std::move(other.first()[index]));
+                            }
+                        }
+                        NP_VECTOR_CATCH(...) {
+                            for (size_type i = 0; i < index; ++i) {
+                                allocator_traits::destroy(allocator_, new_arr + i);
+                            }
+                            allocator_traits::deallocate(allocator_, new_arr, other.size_);
+                            NP_VECTOR_RETHROW;
+                        }
+                    }
+
+                    adopt(new_arr, other.size_, 0);
+                    size_ = other.size_;
+
+                    other.destroy_and_deallocate();
+                    other.capacity_ = 0;
+                    other.front_ = 0;
+                    other.size_ = 0;
+                    other.data_ = nullptr;
+                    return *this;
+                }
+            }
+
+            destroy_and_deallocate();
+            if constexpr (allocator_traits::propagate_on_container_move_assignment::value) {
+                allocator_ = std::move(other.allocator_);
+            }
+
+            capacity_ = std::exchange(other.capacity_, 0);
+            front_ = std::exchange(other.front_, 0);
+            size_ = std::exchange(other.size_, 0);
+            data_ = std::exchange(other.data_, nullptr);
+
+            return *this;
+        }
+
+        void swap(devector& other) noexcept {
+            std::swap(capacity_, other.capacity_);
+            std::swap(front_, other.front_);
+            std::swap(size_, other.size_);
+            std::swap(data_, other.data_);
+            std::swap(allocator_, other.allocator_);
+        }
+
+        // Grows the buffer to new_capacity slots, keeping the current front gap; the extra room goes to the back.
+        void reserve(const size_type new_capacity) {
+            if (new_capacity > capacity_) {
+                reallocate(new_capacity, front_);
+            }
+        }
+
+        // args may refer to elements of this devector.
+        template <typename... Args>
+        reference emplace_back(Args&&... args) {
+            if (back_free_capacity() == 0) [[unlikely]] {
+                grow_and_emplace(false, std::forward<Args>(args)...);
+            }
+            else {
+                allocator_traits::construct(allocator_, last(), std::forward<Args>(args)...);
+                ++size_;
+            }
+
+            return back();
+        }
+
+        // args may refer to elements of this devector.
+        template <typename... Args>
+        reference emplace_front(Args&&... args) {
+            if (front_ == 0) [[unlikely]] {
+                grow_and_emplace(true, std::forward<Args>(args)...);
+            }
+            else {
+                allocator_traits::construct(allocator_, first() - 1, std::forward<Args>(args)...);
+                --front_;
+                ++size_;
+            }
+
+            return front();
+        }
+
+        void push_back(const_reference value) { emplace_back(value); }
+
+        void push_back(value_type&& value) { emplace_back(std::move(value)); }
+
+        void push_front(const_reference value) { emplace_front(value); }
+
+        void push_front(value_type&& value) { emplace_front(std::move(value)); }
+
+        void pop_back() {
+            allocator_traits::destroy(allocator_, last() - 1);
+            --size_;
+        }
+
+        void pop_front() {
+            allocator_traits::destroy(allocator_, first());
+            ++front_;
+            --size_;
+        }
+
+        iterator insert(const_iterator pos, const_reference value) {
+            if (pos < begin() || pos > end()) {
+                NP_VECTOR_THROW(std::out_of_range("Iterator out of range"));
+            }
+
+            const size_type index = static_cast<size_type>(pos - begin());
+
+            if (index == 0) {
+                emplace_front(value);
+                return begin();
+            }
+            if (index == size_) {
+                emplace_back(value);
+                return end() - 1;
+            }
+
+            // value may live in this devector; copy it before elements shift or the buffer moves.
+            value_type copy(value);
+            if (index < size_ / 2) {
+                ensure_front();
+
+                pointer old_first = first();
+                allocator_traits::construct(allocator_, old_first - 1, std::move(*old_first));
+                --front_;
+                ++size_;
+                std::move(old_first + 1, old_first + index, old_first);
+                old_first[index - 1] = std::move(copy);
+            }
+            else {
+                ensure_back();
+
+                pointer old_last = last();
+                allocator_traits::construct(allocator_, old_last, std::move(*(old_last - 1)));
+                ++size_;
+                std::move_backward(first() + index, old_last - 1, old_last);
+                first()[index] = std::move(copy);
+            }
+
+            return begin() + index;
+        }
+
+        iterator erase(const_iterator pos) {
+            return erase(pos, pos + 1);
+        }
+
+        iterator erase(const_iterator first_pos, const_iterator last_pos) {
+            if (first_pos < begin() || last_pos > end() || first_pos > last_pos) {
+                NP_VECTOR_THROW(std::out_of_range("Iterator out of range"));
+            }
+
+            const size_type index = static_cast<size_type>(first_pos - begin());
+            const size_type count = static_cast<size_type>(last_pos - first_pos);
+            const size_type after = size_ - index - count;
+
+            if (index < after) {
+                std::move_backward(first(), first() + index, first() + index + count);
+                for (size_type i = 0; i < count; ++i) {
+                    allocator_traits::destroy(allocator_, first() + i);
+                }
+                front_ += count;
+            }
+            else {
+                std::move(first() + index + count, last(), first() + index);
+                for (size_type i = size_ - count; i < size_; ++i) {
+                    allocator_traits::destroy(allocator_, first() + i);
+                }
+            }
+            size_ -= count;
+
+            return begin() + index;
+        }
+
+        void resize(const size_type count) {
+            while (size_ > count) {
+                pop_back();
+            }
+            if (count > size_) {
+                reserve(front_ + count);
+                while (size_ < count) {
+                    emplace_back();
+                }
+            }
+        }
+
+        void resize(const size_type count, const_reference value) {
+            while (size_ > count) {
+                pop_back();
+            }
+            if (count > size_) {
+                reserve(front_ + count);
+                while (size_ < count) {
+                    emplace_back(value);
+                }
+            }
+        }
+
+        void clear() noexcept {
+            for (size_type i = 0; i < size_; ++i) {
+                allocator_traits::destroy(allocator_, first() + i);
+            }
+
+            // Recentre so that both ends have room again.
+            front_ = capacity_ / 2;
+            size_ = 0;
+        }
+
+        void shrink_to_fit() {
+            if (size_ < capacity_) {
+                if (size_ == 0) {
+                    destroy_and_deallocate();
+                    data_ = nullptr;
+                    capacity_ = 0;
+                    front_ = 0;
+                    return;
+                }
+                reallocate(size_, 0);
+            }
+        }
+
+        [[nodiscard]] size_type size() const noexcept { return size_; }
+        [[nodiscard]] size_type capacity() const noexcept { return capacity_; }
+        [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+        [[nodiscard]] size_type front_free_capacity() const noexcept { return front_; }
+        [[nodiscard]] size_type back_free_capacity() const noexcept { return capacity_ - front_ - size_; }
+
+        allocator_type get_allocator() const noexcept { return allocator_; }
+
+        iterator begin() noexcept { return std::to_address(first()); }
+        const_iterator begin() const noexcept { return std::to_address(first()); }
+        const_iterator cbegin() const noexcept { return begin(); }
+
+        iterator end() noexcept { return std::to_address(last()); }
+        const_iterator end() const noexcept { return std::to_address(last()); }
+        const_iterator cend() const noexcept { return end(); }
+
+        reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+
+        reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+        value_type* data() noexcept { return begin(); }
+        const value_type* data() const noexcept { return begin(); }
+
+        reference front() { return *first(); }
+        const_reference front() const { return *first(); }
+
+        reference back() { return *(last() - 1); }
+        const_reference back() const { return *(last() - 1); }
+
+        reference operator[](const size_type index) {
+            return first()[index];
+        }
+
+        const_reference operator[](const size_type index) const {
+            return first()[index];
+        }
+
+        reference at(const size_type index) {
+            if (index >= size_) {
+                NP_VECTOR_THROW(std::out_of_range("Index out of range"));
+            }
+
+            return first()[index];
+        }
+
+        const_reference at(const size_type index) const {
+            if (index >= size_) {
+                NP_VECTOR_THROW(std::out_of_range("Index out of range"));
+            }
+
+            return first()[index];
+        }
+
+        ~devector() {
+            destroy_and_deallocate();
+        }
+    };
+}
@@ -0,0 +1,390 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+
+#include "../vector/exceptions.hpp"
+#include "../vector/vector.hpp"
+
+namespace np {
+    namespace detail::bitpack {
+        using word_type = std::uint64_t;
+
+        inline constexpr unsigned word_bits = 64;
+
+        // Values per unpack group: 64 values of Width bits fill exactly Width words, so every group
+        // starts on a word boundary regardless of the width.
+        inline constexpr std::size_t group_size = 64;
+
+        constexpr word_type mask(const unsigned width) noexcept {
+            return width >= word_bits ? ~word_type(0) : (word_type(1) << width) - 1;
+        }
+
+        // Words needed to hold n values of the given width, plus one padding word so that a read of
+        // any value may always touch the word after it.
+        constexpr std::size_t required_words(const std::size_t n, const unsigned width) noexcept {
+            return (n * width + word_bits - 1) / word_bits + 1;
+        }
+
+        inline word_type read(const word_type* words, const std::size_t bit, const unsigned width) noexcept {
+            const std::size_t word = bit / word_bits;
+            const unsigned offset = bit % word_bits;
+
+            const word_type lo = words[word] >> offset;
+            // Two shifts so that offset == 0 does not shift by 64.
+            const word_type hi = (words[word + 1] << 1) << (word_bits - 1 - offset);
+
+            return (lo | hi) & mask(width);
+        }
+
+        inline void write(word_type* words, const std::size_t bit, const unsigned width, const word_type value) noexcept {
+            const std::size_t word = bit / word_bits;
+            const unsigned offset = bit % word_bits;
+            const word_type value_mask = mask(width);
+
+            words[word] = (words[word] & ~(value_mask << offset)) | (value << offset);
+            if (offset + width > word_bits) {
+                const unsigned spill = word_bits - offset;
+                words[word + 1] = (words[word + 1] & ~(value_mask >> spill)) | (value >> spill);
+            }
+        }
+
+        // Grows words to at least n zeroed words, doubling the capacity so appends stay amortized O(1).
+        template <typename Words>
+        void grow(Words& words, const std::size_t n) {
+            if (n > words.capacity()) {
+                words.reserve(std::max(n, words.capacity() * 2));
+            }
+            if (n > words.size()) {
+                words.resize(n, 0);
+            }
+        }
+
+        // Unpacks whole groups with the width as a compile-time constant, so the shifts and masks are
+        // immediates and the compiler can unroll and vectorize the inner loop.
+        template <unsigned Width>
+        void unpack_groups(const word_type* words, const std::size_t groups, word_type* out, const word_type base) noexcept {
+            for (std::size_t group = 0; group < groups; ++group) {
+                const word_type* in = words + group * Width;
+                word_type* dst = out + group * group_size;
+
+                for (std::size_t j = 0; j < group_size; ++j) {
+                    if constexpr (Width == 0) {
+                        dst[j] = base;
+                    }
+                    else {
+                        const std::size_t bit = j * Width;
+                        const std::size_t word = bit / word_bits;
+                        const unsigned offset = bit % word_bits;
+
+                        word_type value = in[word] >> offset;
+                        if (offset + Width > word_bits) {
+                            value |= in[word + 1] << (word_bits - offset);
+                        }
+                        dst[j] = base + (value & mask(Width));
+                    }
+                }
+            }
+        }
+
+        using unpack_groups_fn = void (*)(const word_type*, std::size_t, word_type*, word_type) noexcept;
+
+        template <std::size_t... Widths>
+        constexpr std::array<unpack_groups_fn, sizeof...(Widths)> make_unpack_table(std::index_sequence<Widths...>) noexcept {
+            return {&unpack_groups<static_cast<unsigned>(Widths)>...};
+        }
+
+        inline constexpr std::array<unpack_groups_fn, word_bits + 1> unpack_table = make_unpack_table(std::make_index_sequence<word_bits + 1>());
+
+        // Writes base + value for n values of the given width starting at the first bit of words.
+        inline void unpack(const word_type* words, const std::size_t n, const unsigned width, word_type* out, const word_type base = 0) noexcept {
+            // Width 0 stores nothing; a width-0 block may own no words at all, so read() must not run.
+            if (width == 0) {
+                std::fill_n(out, n, base);
+                return;
+            }
+
+            const std::size_t groups = n / group_size;
+            unpack_table[width](words, groups, out, base);
+
+            for (std::size_t i = groups * group_size; i < n; ++i) {
+                out[i] = base + read(words, i * width, width);
+            }
+        }
+    }
+
+    // Vector of unsigned 64-bit integers stored at a fixed bit width: the smallest width that holds
+    // every stored value. Storing a wider value repacks the whole vector at the new width. Random
+    // access is O(1); values are returned by value, use set() to modify them.
+    class packed_vector {
+    public:
+        using value_type = std::uint64_t;
+        using size_type = std::size_t;
+
+    private:
+        using word_type = detail::bitpack::word_type;
+
+        vector<word_type> words_;
+        size_type size_ = 0;
+        unsigned width_ = 0;
+
+        void ensure_width(const value_type value) {
+            const unsigned needed = static_cast<unsigned>(std::bit_width(value));
+            if (needed > width_) {
+                repack(needed);
+            }
+        }
+
+        void repack(const unsigned new_width) {
+            vector<word_type> new_words(detail::bitpack::required_words(size_, new_width), 0);
+
+            for (size_type i = 0; i < size_; ++i) {
+                detail::bitpack::write(new_words.data(), i * new_width, new_width, (*this)[i]);
+            }
+
+            words_ = std::move(new_words);
+            width_ = new_width;
+        }
+
+    public:
+        packed_vector() = default;
+
+        explicit packed_vector(const vector<value_type>& values) {
+            value_type all_bits = 0;
+            for (size_type i = 0; i < values.size(); ++i) {
+                all_bits |= values[i];
+            }
+
+            width_ = static_cast<unsigned>(std::bit_width(all_bits));
+            size_ = values.size();
+            words_.resize(detail::bitpack::required_words(size_, width_), 0);
+
+            for (size_type i = 0; i < size_; ++i) {
+                detail::bitpack::write(words_.data(), i * width_, width_, values[i]);
+            }
+        }
+
+        packed_vector(const std::initializer_list<value_type>& list) : packed_vector(vector<value_type>(list)) {}
+
+        value_type operator[](const size_type index) const noexcept {
+            if (width_ == 0) {
+                return 0;
+            }
+
+            return detail::bitpack::read(words_.data(), index * width_, width_);
+        }
+
+        value_type at(const size_type index) const {
+            if (index >= size_) {
+                NP_VECTOR_THROW(std::out_of_range("Index out of range"));
+            }
+
+            return (*this)[index];
+        }
+
+        void set(const size_type index, const value_type value) {
+            if (index >= size_) {
+                NP_VECTOR_THROW(std::out_of_range("Index out of range"));
+            }
+
+            ensure_width(value);
+            if (width_ != 0) {
+                detail::bitpack::write(words_.data(), index * width_, width_, value);
+            }
+        }
+
+        void push_back(const value_type value) {
+            ensure_width(value);
+
+            detail::bitpack::grow(words_, detail::bitpack::required_words(size_ + 1, width_));
+
+            if (width_ != 0) {
+                detail::bitpack::write(words_.data(), size_ * width_, width_, value);
+            }
+            ++size_;
+        }
+
+        void pop_back() {
+            --size_;
+        }
+
+        void reserve(const size_type new_capacity) {
+            words_.reserve(detail::bitpack::required_words(new_capacity, width_));
+        }
+
+        void clear() {
+            words_.clear();
+            size_ = 0;
+            width_ = 0;
+        }
+
+        // Appends every value to out in one pass.
+        void unpack(vector<value_type>& out) const {
+            const size_type offset = out.size();
+            out.resize(offset + size_);
+
+            if (size_ != 0) {
+                detail::bitpack::unpack(words_.data(), size_, width_, out.data() + offset);
+            }
+        }
+
+        [[nodiscard]] size_type size() const noexcept { return size_; }
+        [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+        // Bits per stored value.
+        [[nodiscard]] unsigned width() const noexcept { return width_; }
+
+        // Bytes of packed storage currently allocated.
+        [[nodiscard]] size_type memory_bytes() const noexcept { return words_.capacity() * sizeof(word_type); }
+    };
+
+    // Packed vector for sorted or clustered data. Values are split into blocks of block_size; each
+    // block stores its minimum once and every value as an offset from it, at the smallest width that
+    // fits the block. Sorted IDs and offsets therefore cost a few bits per value however large they
+    // are. Random access is O(1); only push_back is supported for modification.
+    class packed_delta_vector {
+    public:
+        using value_type = std::uint64_t;
+        using size_type = std::size_t;
+
+        // Two unpack groups, so every block starts on a word boundary.
+        static constexpr size_type block_size = 2 * detail::bitpack::group_size;
+
+    private:
+        using word_type = detail::bitpack::word_type;
+
+        vector<value_type> bases_;
+        vector<std::uint8_t> widths_;
+        vector<size_type> offsets_;
+        vector<word_type> words_;
+        size_type size_ = 0;
+
+        // Storage of a block is sized for a full block, so the open last block never moves its neighbours.
+        static size_type block_words(const unsigned width) noexcept {
+            return block_size * width / detail::bitpack::word_bits;
+        }
+
+        void rebuild_last_block(const value_type base, const unsigned width) {
+            const size_type block = bases_.size() - 1;
+            const size_type count = size_ - block * block_size;
+
+            std::array<value_type, block_size> values{};
+            for (size_type i = 0; i < count; ++i) {
+                values[i] = (*this)[block * block_size + i];
+            }
+
+            bases_[block] = base;
+            widths_[block] = static_cast<std::uint8_t>(width);
+            detail::bitpack::grow(words_, offsets_[block] + block_words(width) + 1);
+
+            for (size_type i = 0; i < count; ++i) {
+                detail::bitpack::write(words_.data() + offsets_[block], i * width, width, values[i] - base);
+            }
+        }
+
+    public:
+        packed_delta_vector() = default;
+
+        explicit packed_delta_vector(const vector<value_type>& values) {
+            reserve(values.size());
+            for (size_type i = 0; i < values.size(); ++i) {
+                push_back(values[i]);
+            }
+        }
+
+        packed_delta_vector(const std::initializer_list<value_type>& list) : packed_delta_vector(vector<value_type>(list)) {}
+
+        value_type operator[](const size_type index) const noexcept {
+            const size_type block = index / block_size;
+            const unsigned width = widths_[block];
+            if (width == 0) {
+                return bases_[block];
+            }
+
+            return bases_[block] + detail::bitpack::read(words_.data() + offsets_[block], (index % block_size) * width, width);
+        }
+
+        value_type at(const size_type index) const {
+            if (index >= size_) {
+                NP_VECTOR_THROW(std::out_of_range("Index out of range"));
+            }
+
+            return (*this)[index];
+        }
+
+        void push_back(const value_type value) {
+            if (size_ % block_size == 0) {
+                const size_type offset = offsets_.empty() ? 0 : offsets_.back() + block_words(widths_.back());
+
+                bases_.push_back(value);
+                widths_.push_back(0);
+                offsets_.push_back(offset);
+                detail::bitpack::grow(words_, offset + 1);
+                ++size_;
+                return;
+            }
+
+            const size_type block = bases_.size() - 1;
+            const value_type old_base = bases_[block];
+            const unsigned old_width = widths_[block];
+
+            value_type base = old_base;
+            unsigned width = old_width;
+            if (value >= old_base) {
+                width = std::max(width, static_cast<unsigned>(std::bit_width(value - old_base)));
+            }
+            else {
+                // Re-basing shifts every stored offset up by the distance to the new minimum.
+                const value_type shift = old_base - value;
+                const value_type top = detail::bitpack::mask(old_width);
+                base = value;
+                width = top > ~value_type(0) - shift ? detail::bitpack::word_bits : static_cast<unsigned>(std::bit_width(top + shift));
+            }
+
+            if (base != old_base || width != old_width) {
+                rebuild_last_block(base, width);
+            }
+
+            if (width != 0) {
+                detail::bitpack::write(words_.data() + offsets_[block], (size_ - block * block_size) * width, width, value - base);
+            }
+            ++size_;
+        }
+
+        void reserve(const size_type new_capacity) {
+            const size_type blocks = (new_capacity + block_size - 1) / block_size;
+            bases_.reserve(blocks);
+            widths_.reserve(blocks);
+            offsets_.reserve(blocks);
+        }
+
+        // Appends every value to out in one pass.
+        void unpack(vector<value_type>& out) const {
+            const size_type offset = out.size();
+            out.resize(offset + size_);
+
+            for (size_type block = 0; block < bases_.size(); ++block) {
+                const size_type first = block * block_size;
+                const size_type count = std::min(block_size, size_ - first);
+                detail::bitpack::unpack(words_.data() + offsets_[block], count, widths_[block], out.data() + offset + first, bases_[block]);
+            }
+        }
+
+        [[nodiscard]] size_type size() const noexcept { return size_; }
+        [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+        // Bytes of packed storage and per-block metadata currently allocated.
+        [[nodiscard]] size_type memory_bytes() const noexcept {
+            return words_.capacity() * sizeof(word_type)
+                + bases_.capacity() * sizeof(value_type)
+                + widths_.capacity() * sizeof(std::uint8_t)
+                + offsets_.capacity() * sizeof(size_type);
+        }
+    };
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#include "exceptions.hpp"
+
+namespace np {
+    // Allocator that hands out storage aligned to Alignment bytes (cache line / SIMD register width).
+    // Every block is followed by at least Padding bytes of slack, so a vectorized loop may over-read
+    // past the last element without leaving the allocation.
+    template <typename T, std::size_t Alignment = 64, std::size_t Padding = 0>
+    class aligned_allocator {
+        static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+        static_assert(Alignment >= alignof(T), "Alignment must not be weaker than alignof(T)");
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        using propagate_on_container_move_assignment = std::true_type;
+        using is_always_equal = std::true_type;
+
+        static constexpr std::size_t alignment = Alignment;
+        static constexpr std::size_t padding = Padding;
+
+        template <typename U>
+        struct rebind {
+            using other = aligned_allocator<U, Alignment, Padding>;
+        };
+
+        aligned_allocator() noexcept = default;
+
+        template <typename U>
+        aligned_allocator(const aligned_allocator<U, Alignment, Padding>&) noexcept {}
+
+        [[nodiscard]] T* allocate(const size_type n) {
+            if (n > max_size()) {
+                NP_VECTOR_THROW(std::bad_array_new_length());
+            }
+
+            return static_cast<T*>(::operator new(storage_size(n), std::align_val_t{Alignment}));
+        }
+
+        // allocate() that returns nullptr instead of throwing; np::vector's try_* members use it.
+        [[nodiscard]] T* try_allocate(const size_type n) noexcept {
+            if (n > max_size()) {
+                return nullptr;
+            }
+
+            return static_cast<T*>(::operator new(storage_size(n), std::align_val_t{Alignment}, std::nothrow));
+        }
+
+        void deallocate(T* ptr, const size_type n) noexcept {
+            ::operator delete(ptr, storage_size(n), std::align_val_t{Alignment});
+        }
+
+        [[nodiscard]] static constexpr size_type max_size() noexcept {
+            return (std::numeric_limits<size_type>::max() - Padding - Alignment) / sizeof(T);
+        }
+
+        // Bytes actually requested for n elements: payload plus padding, rounded up to whole alignment units.
+        [[nodiscard]] static constexpr size_type storage_size(const size_type n) noexcept {
+            return (n * sizeof(T) + Padding + Alignment - 1) & ~(Alignment - 1);
+        }
+
+        template <typename U>
+        bool operator==(const aligned_allocator<U, Alignment, Padding>&) const noexcept {
+            return true;
+        }
+    };
+
+    // Alignment an allocator guarantees for the pointers it returns.
+    template <typename Allocator>
+    inline constexpr std::size_t allocator_alignment_v = alignof(typename Allocator::value_type);
+
+    template <typename T, std::size_t Alignment, std::size_t Padding>
+    inline constexpr std::size_t allocator_alignment_v<aligned_allocator<T, Alignment, Padding>> = Alignment;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <span>
+#include <utility>
+
+#include "frozen_vector.hpp"
+
+namespace np {
+    // Copy-on-write vector. Copies and snapshots share one buffer; the first mutation through a
+    // shared handle copies the buffer, so readers holding a snapshot never observe the change.
+    // A single cow_vector object is not safe for concurrent writers; share snapshots instead.
+    // There is deliberately no mutable access to the whole buffer: a reference kept past the next
+    // snapshot() would let writes reach that snapshot.
+    template <typename T, typename Allocator = std::allocator<T>>
+    class cow_vector {
+    public:
+        using vector_type = vector<T, Allocator>;
+        using frozen_type = frozen_vector<T, Allocator>;
+
+        using value_type = T;
+        using size_type = typename vector_type::size_type;
+        using const_reference = typename vector_type::const_reference;
+        using const_pointer = typename vector_type::const_pointer;
+        using const_iterator = typename vector_type::const_iterator;
+
+    private:
+        std::shared_ptr<vector_type> buffer_;
+
+        // True if no snapshot or copy shares the buffer. use_count() is a relaxed read; the fence
+        // orders this thread's writes after the reads a snapshot holder on another thread made
+        // before dropping its reference.
+        bool sole_owner() const noexcept {
+            if (buffer_.use_count() != 1) {
+                return false;
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return true;
+        }
+
+        // Unique, mutable access to the buffer, copying it first unless this object is its only owner.
+        vector_type& write() {
+            if (!sole_owner()) {
+                buffer_ = std::make_shared<vector_type>(*buffer_);
+            }
+            return *buffer_;
+        }
+
+    public:
+        cow_vector() noexcept : buffer_(detail::empty_shared_buffer<vector_type>()) {}
+
+        explicit cow_vector(vector_type source) : buffer_(std::make_shared<vector_type>(std::move(source))) {}
+
+        // Shares the snapshot's buffer; it is copied on the first write.
+        explicit cow_vector(const frozen_type& snapshot) : buffer_(std::const_pointer_cast<vector_type>(snapshot.buffer())) {}
+
+        cow_vector(const cow_vector& other) noexcept = default;
+
+        // Leaves other empty.
+        cow_vector(cow_vector&& other) noexcept : buffer_(std::exchange(other.buffer_, detail::empty_shared_buffer<vector_type>())) {}
+
+        cow_vector& operator=(const cow_vector& other) noexcept = default;
+
+        cow_vector& operator=(cow_vector&& other) noexcept {
+            if (this != &other) {
+                buffer_ = std::exchange(other.buffer_, detail::empty_shared_buffer<vector_type>());
+            }
+            return *this;
+        }
+
+        [[nodiscard]] size_type size() const noexcept { return buffer_->size(); }
+        [[nodiscard]] size_type capacity() const noexcept { return buffer_->capacity(); }
+        [[nodiscard]] bool empty() const noexcept { return buffer_->empty(); }
+
+        const_reference operator[](const size_type index) const { return (*buffer_)[index]; }
+        const_reference at(const size_type index) const { return buffer_->at(index); }
+
+        const_reference front() const { return buffer_->front(); }
+        const_reference back() const { return buffer_->back(); }
+
+        const_pointer data() const noexcept { return buffer_->data(); }
+
+        const_iterator begin() const noexcept { return buffer_->cbegin(); }
+        const_iterator end() const noexcept { return buffer_->cend(); }
+        const_iterator cbegin() const noexcept { return buffer_->cbegin(); }
+        const_iterator cend() const noexcept { return buffer_->cend(); }
+
+        operator std::span<const T>() const noexcept { return std::span<const T>(data(), size()); }
+
+        [[nodiscard]] bool shared() const noexcept { return buffer_.use_count() > 1; }
+
+        // Immutable snapshot of the current contents. Costs a reference count, not a copy.
+        frozen_type snapshot() const { return frozen_type(std::shared_ptr<const vector_type>(buffer_)); }
+
+        void set(const size_type index, const_reference value) { write()[index] = value; }
+
+        void push_back(const_reference value) { write().push_back(value); }
+        void pop_back() { write().pop_back(); }
+
+        void reserve(const size_type new_capacity) { write().reserve(new_capacity); }
+        void resize(const size_type count) { write().resize(count); }
+        void resize(const size_type count, const_reference value) { write().resize(count, value); }
+
+        void clear() {
+            if (!sole_owner()) {
+                buffer_ = std::make_shared<vector_type>();
+                return;
+            }
+            buffer_->clear();
+        }
+    };
+}
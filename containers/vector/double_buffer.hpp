@@ -0,0 +1,136 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <ranges>
+#include <span>
+#include <utility>
+
+#include "generator.hpp"
+#include "vector.hpp"
+
+namespace np {
+    // Two np::vectors handed back and forth between one producer and one consumer thread: the
+    // producer fills one batch while the consumer drains the other. At most two batches are in
+    // flight, so a slow consumer blocks the producer. Both buffers are reserved up front and only
+    // cleared between batches, so a steady stream of batches of at most batch_capacity elements
+    // allocates nothing.
+    template <typename T, typename Allocator = std::allocator<T>>
+    class double_buffer {
+    public:
+        using vector_type = vector<T, Allocator>;
+        using size_type = typename vector_type::size_type;
+
+    private:
+        enum class slot_state { empty, filling, ready, draining };
+
+        vector_type buffers_[2];
+        slot_state states_[2] = {slot_state::empty, slot_state::empty};
+        unsigned fill_index_ = 0;
+        unsigned drain_index_ = 0;
+        bool closed_ = false;
+        size_type batch_capacity_;
+
+        std::mutex mutex_;
+        std::condition_variable changed_;
+
+    public:
+        explicit double_buffer(const size_type batch_capacity) : batch_capacity_(batch_capacity) {
+            buffers_[0].reserve(batch_capacity);
+            buffers_[1].reserve(batch_capacity);
+        }
+
+        double_buffer(const double_buffer&) = delete;
+        double_buffer& operator=(const double_buffer&) = delete;
+
+        [[nodiscard]] size_type batch_capacity() const noexcept { return batch_capacity_; }
+
+        // Producer: waits for a free buffer and returns it, empty.
+        vector_type& begin_fill() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            changed_.wait(lock, [this] { return states_[fill_index_] == slot_state::empty; });
+
+            states_[fill_index_] = slot_state::filling;
+            return buffers_[fill_index_];
+        }
+
+        // Producer: hands the buffer from begin_fill() to the consumer.
+        void end_fill() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                states_[fill_index_] = slot_state::ready;
+                fill_index_ ^= 1;
+            }
+            changed_.notify_all();
+        }
+
+        // Producer: no more batches will follow. A batch being filled is discarded.
+        void close() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                closed_ = true;
+            }
+            changed_.notify_all();
+        }
+
+        // Consumer: waits for the next batch; nullptr once the producer closed and everything was drained.
+        const vector_type* begin_drain() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            changed_.wait(lock, [this] { return states_[drain_index_] == slot_state::ready || closed_; });
+
+            if (states_[drain_index_] != slot_state::ready) {
+                return nullptr;
+            }
+
+            states_[drain_index_] = slot_state::draining;
+            return &buffers_[drain_index_];
+        }
+
+        // Consumer: returns the buffer from begin_drain() to the producer, keeping its capacity.
+        void end_drain() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                buffers_[drain_index_].clear();
+                states_[drain_index_] = slot_state::empty;
+                drain_index_ ^= 1;
+            }
+            changed_.notify_all();
+        }
+
+        // Producer: splits source into batches of batch_capacity() elements, publishes each and closes,
+        // also when source throws.
+        template <std::ranges::input_range Range>
+        void produce(Range&& source) {
+            struct close_guard {
+                double_buffer* self;
+                ~close_guard() { self->close(); }
+            } guard{this};
+
+            auto it = std::ranges::begin(source);
+            const auto last = std::ranges::end(source);
+
+            while (it != last) {
+                vector_type& batch = begin_fill();
+                for (; it != last && batch.size() < batch_capacity_; ++it) {
+                    batch.push_back(*it);
+                }
+                end_fill();
+            }
+        }
+
+        // Consumer: yields every batch as a span, which stays valid until the generator is resumed.
+        // Abandoning the generator releases the batch it was holding.
+        generator<std::span<const T>> batches() {
+            struct drain_guard {
+                double_buffer* self;
+                ~drain_guard() { self->end_drain(); }
+            };
+
+            while (const vector_type* batch = begin_drain()) {
+                drain_guard guard{this};
+                co_yield std::span<const T>(std::to_address(batch->data()), batch->size());
+            }
+        }
+    };
+}
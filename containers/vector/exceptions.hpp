@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+// The np containers build with and without exception support. Under -fno-exceptions every error
+// that would throw prints the exception's message and aborts instead; running out of memory can
+// still be handled through np::vector's try_* members.
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+#define NP_VECTOR_EXCEPTIONS 1
+#define NP_VECTOR_TRY try
+#define NP_VECTOR_CATCH(declaration) catch (declaration)
+#define NP_VECTOR_RETHROW throw
+#define NP_VECTOR_THROW(exception) throw exception
+#else
+#define NP_VECTOR_EXCEPTIONS 0
+#define NP_VECTOR_TRY if (true)
+#define NP_VECTOR_CATCH(declaration) else
+#define NP_VECTOR_RETHROW static_cast<void>(0)
+#define NP_VECTOR_THROW(exception) ::np::detail::fail(exception)
+#endif
+
+namespace np::detail {
+    template <typename Exception>
+    [[noreturn, gnu::cold]] void fail(const Exception& error) noexcept {
+        std::fputs(error.what(), stderr);
+        std::fputc('\n', stderr);
+        std::abort();
+    }
+}
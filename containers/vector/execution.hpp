@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <system_error>
+#include <thread>
+
+#include "exceptions.hpp"
+
+namespace np {
+    // How the pages of a parallel-initialized buffer are spread over the worker threads. Linux places
+    // a page on the NUMA node of the thread that first writes it, so the layout decides where the
+    // memory lives. Workers are not pinned; pin the process (numactl, taskset) for a stable placement.
+    enum class first_touch {
+        blocked,     // each worker initializes one contiguous slice: local to a later scan split the same way
+        interleaved  // pages are dealt round-robin to the workers: spread evenly over all nodes
+    };
+
+    // Execution policy for np::vector's parallel construction and resize overloads.
+    struct parallel_policy {
+        unsigned threads = 0;  // 0 means std::thread::hardware_concurrency()
+        first_touch placement = first_touch::blocked;
+        std::size_t min_bytes_per_thread = std::size_t(1) << 20;  // smaller jobs use fewer threads
+
+        [[nodiscard]] constexpr parallel_policy with_threads(const unsigned count) const noexcept {
+            parallel_policy policy = *this;
+            policy.threads = count;
+            return policy;
+        }
+
+        [[nodiscard]] constexpr parallel_policy with_placement(const first_touch layout) const noexcept {
+            parallel_policy policy = *this;
+            policy.placement = layout;
+            return policy;
+        }
+
+        [[nodiscard]] constexpr parallel_policy with_min_bytes_per_thread(const std::size_t bytes) const noexcept {
+            parallel_policy policy = *this;
+            policy.min_bytes_per_thread = bytes;
+            return policy;
+        }
+    };
+
+    inline constexpr parallel_policy par{};
+
+    namespace detail::parallel {
+        inline constexpr std::size_t page_bytes = 4096;
+
+        // Splits the elements [0, count) of an array into stripes that start on page boundaries of the
+        // array's memory and assigns them to workers. Stripe 0 runs up to the first page boundary after
+        // the array's start and always belongs to worker 0; every other stripe spans stripe_bytes
+        // (whole pages). A stripe starts at the first element that starts at or after its boundary, so
+        // unless elements straddle pages, every page is first touched by exactly one worker.
+        struct partition {
+            std::size_t count = 0;
+            std::size_t element_bytes = 1;
+            std::size_t lead_bytes = page_bytes;
+            std::size_t stripe_bytes = page_bytes;
+            std::size_t stripes = 0;
+            unsigned workers = 1;
+            first_touch placement = first_touch::blocked;
+
+            // Index of the first element of stripe s.
+            std::size_t bound(const std::size_t s) const noexcept {
+                if (s == 0) {
+                    return 0;
+                }
+
+                const std::size_t byte = lead_bytes + (s - 1) * stripe_bytes;
+                return std::min(count, (byte + element_bytes - 1) / element_bytes);
+            }
+
+            template <typename F>
+            void for_each_range(const unsigned worker, F&& f) const {
+                auto visit = [&](const std::size_t first_stripe, const std::size_t last_stripe) {
+                    const std::size_t begin = bound(first_stripe);
+                    const std::size_t end = bound(last_stripe);
+                    if (begin < end) {
+                        f(begin, end);
+                    }
+                };
+
+                if (placement == first_touch::interleaved) {
+                    for (std::size_t s = worker; s < stripes; s += workers) {
+                        visit(s, s + 1);
+                    }
+                    return;
+                }
+
+                visit(stripes * worker / workers, stripes * (worker + 1) / workers);
+            }
+        };
+
+        // first is the address of element 0; stripes are aligned to its pages.
+        template <typename T>
+        partition make_partition(const parallel_policy& policy, const std::size_t count, const void* first = nullptr) {
+            partition result;
+            result.count = count;
+            result.element_bytes = sizeof(T);
+            result.stripe_bytes = (sizeof(T) + page_bytes - 1) / page_bytes * page_bytes;
+            result.lead_bytes = page_bytes - reinterpret_cast<std::uintptr_t>(first) % page_bytes;
+            result.placement = policy.placement;
+
+            const std::size_t total_bytes = count * sizeof(T);
+            result.stripes = total_bytes <= result.lead_bytes ? 1 : 1 + (total_bytes - result.lead_bytes + result.stripe_bytes - 1) / result.stripe_bytes;
+
+            const std::size_t requested = policy.threads != 0 ? policy.threads : std::max(1u, std::thread::hardware_concurrency());
+            const std::size_t useful = total_bytes / std::max<std::size_t>(1, policy.min_bytes_per_thread);
+            result.workers = static_cast<unsigned>(std::clamp<std::size_t>(useful, 1, std::min(requested, result.stripes)));
+
+            return result;
+        }
+
+        // Calls construct(begin, end) for every range of the partition, spread over its workers, with
+        // the calling thread as worker 0. construct must either fill its whole range or clean it up and
+        // throw. If any range fails, every completed range is passed to destroy(begin, end) and the
+        // first exception is rethrown, so nothing is left constructed.
+        template <typename Construct, typename Destroy>
+        void construct_ranges(const partition& part, Construct&& construct, Destroy&& destroy) {
+            auto run = [&](const unsigned worker) -> std::exception_ptr {
+                std::size_t done = 0;
+                NP_VECTOR_TRY {
+                    part.for_each_range(worker, [&](const std::size_t begin, const std::size_t end) {
+                        construct(begin, end);
+                        done = end;
+                    });
+                }
+                NP_VECTOR_CATCH(...) {
+                    part.for_each_range(worker, [&](const std::size_t begin, const std::size_t end) {
+                        if (end <= done) {
+                            destroy(begin, end);
+                        }
+                    });
+                    return std::current_exception();
+                }
+                return nullptr;
+            };
+
+            if (part.workers <= 1) {
+                if (std::exception_ptr error = run(0)) {
+                    std::rethrow_exception(error);
+                }
+                return;
+            }
+
+            std::unique_ptr<std::exception_ptr[]> errors(new std::exception_ptr[part.workers]);
+            {
+                std::unique_ptr<std::jthread[]> threads(new std::jthread[part.workers - 1]);
+                for (unsigned worker = 1; worker < part.workers; ++worker) {
+                    NP_VECTOR_TRY {
+                        threads[worker - 1] = std::jthread([&, worker] { errors[worker] = run(worker); });
+                    }
+                    NP_VECTOR_CATCH(const std::system_error&) {
+                        // Out of threads: do this worker's share here instead.
+                        errors[worker] = run(worker);
+                    }
+                }
+                errors[0] = run(0);
+            }
+
+            std::exception_ptr first_error;
+            for (unsigned worker = 0; worker < part.workers; ++worker) {
+                if (errors[worker] && !first_error) {
+                    first_error = errors[worker];
+                }
+            }
+            if (!first_error) {
+                return;
+            }
+
+            for (unsigned worker = 0; worker < part.workers; ++worker) {
+                if (!errors[worker]) {
+                    part.for_each_range(worker, destroy);
+                }
+            }
+            std::rethrow_exception(first_error);
+        }
+    }
+}
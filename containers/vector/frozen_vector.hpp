@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <span>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace np {
+    namespace detail {
+        // Buffer that default-constructed and moved-from frozen and cow vectors point at, so they stay
+        // usable without allocating. Nobody owns it (use_count() == 0), so cow_vector copies it before
+        // its first write.
+        template <typename Vector>
+        std::shared_ptr<Vector> empty_shared_buffer() noexcept {
+            static Vector empty;
+            return std::shared_ptr<Vector>(std::shared_ptr<Vector>(), &empty);
+        }
+    }
+
+    template <typename T, typename Allocator>
+    class cow_vector;
+
+    template <typename T, typename Allocator>
+    class atomic_frozen_vector;
+
+    // Immutable, reference-counted view of a vector's buffer. Copies share the buffer, so handing a
+    // snapshot to any number of reader threads costs one atomic increment and no element copies.
+    // The shared vector itself is never created const, which lets cow_vector adopt and mutate it
+    // once it holds the last reference.
+    template <typename T, typename Allocator = std::allocator<T>>
+    class frozen_vector {
+    public:
+        using vector_type = vector<T, Allocator>;
+
+        using value_type = T;
+        using size_type = typename vector_type::size_type;
+        using difference_type = typename vector_type::difference_type;
+        using const_reference = typename vector_type::const_reference;
+        using const_pointer = typename vector_type::const_pointer;
+        using const_iterator = typename vector_type::const_iterator;
+
+    private:
+        std::shared_ptr<const vector_type> buffer_;
+
+        // Private so every buffer is created non-const by this file or cow_vector, which is what lets
+        // cow_vector cast constness away again.
+        explicit frozen_vector(std::shared_ptr<const vector_type> buffer) noexcept : buffer_(std::move(buffer)) {}
+
+        friend class cow_vector<T, Allocator>;
+        friend class atomic_frozen_vector<T, Allocator>;
+
+    public:
+        frozen_vector() noexcept : buffer_(detail::empty_shared_buffer<vector_type>()) {}
+
+        explicit frozen_vector(vector_type&& source) : buffer_(std::make_shared<vector_type>(std::move(source))) {}
+
+        frozen_vector(const frozen_vector& other) noexcept = default;
+
+        // Leaves other empty.
+        frozen_vector(frozen_vector&& other) noexcept : buffer_(std::exchange(other.buffer_, detail::empty_shared_buffer<vector_type>())) {}
+
+        frozen_vector& operator=(const frozen_vector& other) noexcept = default;
+
+        frozen_vector& operator=(frozen_vector&& other) noexcept {
+            if (this != &other) {
+                buffer_ = std::exchange(other.buffer_, detail::empty_shared_buffer<vector_type>());
+            }
+            return *this;
+        }
+
+        [[nodiscard]] size_type size() const noexcept { return buffer_->size(); }
+        [[nodiscard]] bool empty() const noexcept { return buffer_->empty(); }
+
+        const_reference operator[](const size_type index) const { return (*buffer_)[index]; }
+        const_reference at(const size_type index) const { return buffer_->at(index); }
+
+        const_reference front() const { return buffer_->front(); }
+        const_reference back() const { return buffer_->back(); }
+
+        const_pointer data() const noexcept { return buffer_->data(); }
+
+        const_iterator begin() const noexcept { return buffer_->begin(); }
+        const_iterator end() const noexcept { return buffer_->end(); }
+        const_iterator cbegin() const noexcept { return buffer_->cbegin(); }
+        const_iterator cend() const noexcept { return buffer_->cend(); }
+
+        operator std::span<const T>() const noexcept { return std::span<const T>(data(), size()); }
+
+        const vector_type& get() const noexcept { return *buffer_; }
+
+        const std::shared_ptr<const vector_type>& buffer() const noexcept { return buffer_; }
+
+        [[nodiscard]] long use_count() const noexcept { return buffer_.use_count(); }
+    };
+
+    // RCU-style publication point for frozen vectors. Readers load() the current snapshot and keep
+    // using it for as long as they like; writers publish a new one with store() or update(). The old
+    // buffer is released when its last reader drops it, so readers never wait for writers.
+    template <typename T, typename Allocator = std::allocator<T>>
+    class atomic_frozen_vector {
+    public:
+        using frozen_type = frozen_vector<T, Allocator>;
+        using vector_type = typename frozen_type::vector_type;
+
+    private:
+        std::atomic<std::shared_ptr<const vector_type>> current_;
+
+    public:
+        atomic_frozen_vector() : current_(std::make_shared<vector_type>()) {}
+
+        explicit atomic_frozen_vector(const frozen_type& initial) : current_(initial.buffer()) {}
+
+        atomic_frozen_vector(const atomic_frozen_vector&) = delete;
+        atomic_frozen_vector& operator=(const atomic_frozen_vector&) = delete;
+
+        frozen_type load() const {
+            return frozen_type(current_.load(std::memory_order_acquire));
+        }
+
+        void store(const frozen_type& value) {
+            current_.store(value.buffer(), std::memory_order_release);
+        }
+
+        frozen_type exchange(const frozen_type& value) {
+            return frozen_type(current_.exchange(value.buffer(), std::memory_order_acq_rel));
+        }
+
+        // Copies the current snapshot, applies mutate to the copy and publishes it. If another writer
+        // published first, the copy is discarded and mutate runs again on the newer snapshot.
+        template <typename Mutate>
+        frozen_type update(Mutate&& mutate) {
+            std::shared_ptr<const vector_type> expected = current_.load(std::memory_order_acquire);
+            for (;;) {
+                std::shared_ptr<vector_type> next = std::make_shared<vector_type>(*expected);
+                mutate(*next);
+
+                std::shared_ptr<const vector_type> desired = std::move(next);
+                if (current_.compare_exchange_weak(expected, desired, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    return frozen_type(std::move(desired));
+                }
+            }
+        }
+    };
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace np {
+    // Lazily evaluated input range produced by a coroutine that co_yields values of type T; a minimal
+    // stand-in for C++23 std::generator, which libstdc++ 12 doesn't ship. Each yielded value is moved
+    // into the promise and handed out as T&&, so consumers may move from it. Exceptions thrown by the
+    // coroutine surface from begin() or operator++.
+    template <typename T>
+    class generator {
+    public:
+        using value_type = std::remove_cvref_t<T>;
+
+        struct promise_type {
+            std::optional<value_type> current_;
+            std::exception_ptr error_;
+
+            generator get_return_object() noexcept {
+                return generator(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            std::suspend_always final_suspend() const noexcept { return {}; }
+
+            template <typename U = value_type>
+                requires std::constructible_from<value_type, U>
+            std::suspend_always yield_value(U&& value) noexcept(std::is_nothrow_constructible_v<value_type, U>) {
+                current_.emplace(std::forward<U>(value));
+                return {};
+            }
+
+            void return_void() const noexcept {}
+
+            void unhandled_exception() noexcept {
+                error_ = std::current_exception();
+            }
+
+            // Disallow co_await inside generators.
+            void await_transform() = delete;
+        };
+
+        class iterator {
+            std::coroutine_handle<promise_type> handle_;
+
+        public:
+            using value_type = generator::value_type;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() noexcept = default;
+
+            explicit iterator(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+            value_type&& operator*() const noexcept {
+                return std::move(*handle_.promise().current_);
+            }
+
+            iterator& operator++() {
+                advance(handle_);
+                return *this;
+            }
+
+            void operator++(int) {
+                ++*this;
+            }
+
+            friend bool operator==(const iterator& it, std::default_sentinel_t) noexcept {
+                return !it.handle_ || it.handle_.done();
+            }
+        };
+
+    private:
+        std::coroutine_handle<promise_type> handle_;
+
+        explicit generator(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+        static void advance(std::coroutine_handle<promise_type> handle) {
+            handle.promise().current_.reset();
+            handle.resume();
+
+            if (handle.promise().error_) {
+                std::rethrow_exception(std::exchange(handle.promise().error_, nullptr));
+            }
+        }
+
+    public:
+        generator(const generator&) = delete;
+        generator& operator=(const generator&) = delete;
+
+        generator(generator&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+        generator& operator=(generator&& other) noexcept {
+            if (this != &other) {
+                if (handle_) {
+                    handle_.destroy();
+                }
+                handle_ = std::exchange(other.handle_, nullptr);
+            }
+            return *this;
+        }
+
+        // Starts the coroutine; may be called once.
+        iterator begin() {
+            if (handle_) {
+                advance(handle_);
+            }
+            return iterator(handle_);
+        }
+
+        std::default_sentinel_t end() const noexcept {
+            return std::default_sentinel;
+        }
+
+        ~generator() {
+            if (handle_) {
+                handle_.destroy();
+            }
+        }
+    };
+}
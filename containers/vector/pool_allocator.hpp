@@ -0,0 +1,419 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+#include "exceptions.hpp"
+#include "vector.hpp"
+
+namespace np {
+    // Process-wide counters of the pool allocator, summed over all thread caches.
+    struct pool_stats {
+        std::uint64_t allocations = 0;
+        std::uint64_t deallocations = 0;
+        std::uint64_t cache_hits = 0;          // allocations served from a thread cache
+        std::uint64_t system_allocations = 0;  // allocations that went to operator new
+        std::uint64_t remote_frees = 0;        // blocks freed by a thread other than their owner
+        std::uint64_t remote_batches = 0;      // batches in which those blocks were handed back
+        std::uint64_t cached_bytes = 0;        // payload bytes currently parked in thread caches
+    };
+
+    namespace detail::pool {
+        // Size classes are powers of two from 16 B to 16 MiB of payload, matching the capacities
+        // np::vector reaches by doubling. Larger requests bypass the caches.
+        inline constexpr unsigned min_class_shift = 4;
+        inline constexpr std::uint32_t class_count = 21;
+        inline constexpr std::uint32_t uncached = class_count;
+
+        // Bytes a thread keeps cached per size class before returning blocks to the system.
+        inline constexpr std::size_t cache_limit_bytes = std::size_t(1) << 20;
+
+        // Remote frees are handed back to their owner once this many are pending for it.
+        inline constexpr std::size_t remote_batch_size = 32;
+        inline constexpr std::size_t pending_slots = 4;
+
+        // Smaller batches are handed back on the freeing thread's allocation slow path, or once the
+        // thread has freed this many more blocks, so a thread that stops freeing remotely doesn't
+        // hold on to them.
+        inline constexpr std::uint64_t remote_flush_interval = 256;
+
+        inline constexpr std::size_t header_size = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+        struct thread_cache;
+
+        // Precedes every block's payload.
+        struct header {
+            thread_cache* owner;
+            std::uint32_t size_class;
+        };
+
+        static_assert(sizeof(header) <= header_size);
+
+        // Overlays the payload of a free block.
+        struct free_block {
+            free_block* next;
+        };
+
+        constexpr std::uint32_t size_class_of(const std::size_t bytes) noexcept {
+            if (bytes <= (std::size_t(1) << min_class_shift)) {
+                return 0;
+            }
+
+            const std::uint32_t size_class = static_cast<std::uint32_t>(std::bit_width(bytes - 1)) - min_class_shift;
+            return size_class < class_count ? size_class : uncached;
+        }
+
+        constexpr std::size_t class_bytes(const std::uint32_t size_class) noexcept {
+            return std::size_t(1) << (size_class + min_class_shift);
+        }
+
+        constexpr std::size_t class_limit(const std::uint32_t size_class) noexcept {
+            return std::max<std::size_t>(1, cache_limit_bytes / class_bytes(size_class));
+        }
+
+        inline header* header_of(void* payload) noexcept {
+            return reinterpret_cast<header*>(static_cast<char*>(payload) - header_size);
+        }
+
+        // Sits at the head of an orphaned cache's remote list in place of any blocks.
+        inline free_block orphan_mark{nullptr};
+
+        // Counters are written only by the owning thread, so a relaxed load + store is enough and
+        // avoids contended read-modify-writes; pool_statistics() reads them from any thread.
+        inline void bump(std::atomic<std::uint64_t>& counter, const std::uint64_t value = 1) noexcept {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        struct thread_cache {
+            free_block* lists[class_count] = {};
+            std::size_t list_sizes[class_count] = {};
+
+            // Blocks freed by other threads, pushed in batches and drained by the owner. Holds
+            // &orphan_mark while no thread owns the cache, so the orphan check and the push are one CAS.
+            std::atomic<free_block*> remote{nullptr};
+
+            struct pending_batch {
+                thread_cache* owner = nullptr;
+                free_block* head = nullptr;
+                free_block* tail = nullptr;
+                std::size_t count = 0;
+            };
+
+            // Remote frees this thread has not handed back yet, grouped by owner.
+            pending_batch pending[pending_slots];
+            std::size_t pending_count = 0;
+            std::uint64_t pending_since = 0;  // deallocations when the oldest pending free was deferred
+
+            std::atomic<std::uint64_t> allocations{0};
+            std::atomic<std::uint64_t> deallocations{0};
+            std::atomic<std::uint64_t> cache_hits{0};
+            std::atomic<std::uint64_t> system_allocations{0};
+            std::atomic<std::uint64_t> remote_frees{0};
+            std::atomic<std::uint64_t> remote_batches{0};
+            std::atomic<std::uint64_t> cached_bytes{0};
+
+            void push_local(free_block* block, const std::uint32_t size_class) noexcept {
+                if (list_sizes[size_class] >= class_limit(size_class)) {
+                    ::operator delete(header_of(block));
+                    return;
+                }
+
+                block->next = lists[size_class];
+                lists[size_class] = block;
+                ++list_sizes[size_class];
+                bump(cached_bytes, class_bytes(size_class));
+            }
+
+            free_block* pop_local(const std::uint32_t size_class) noexcept {
+                free_block* block = lists[size_class];
+                if (block != nullptr) {
+                    lists[size_class] = block->next;
+                    --list_sizes[size_class];
+                    cached_bytes.store(cached_bytes.load(std::memory_order_relaxed) - class_bytes(size_class), std::memory_order_relaxed);
+                }
+                return block;
+            }
+
+            // Hands a list of blocks back to this cache from another thread. Blocks freed to an orphan
+            // go straight back to the system instead of piling up until a new thread adopts it.
+            void give_back(free_block* head, free_block* tail) noexcept {
+                free_block* expected = remote.load(std::memory_order_relaxed);
+                do {
+                    if (expected == &orphan_mark) {
+                        for (free_block* block = head; block != nullptr;) {
+                            free_block* next = block == tail ? nullptr : block->next;
+                            ::operator delete(header_of(block));
+                            block = next;
+                        }
+                        return;
+                    }
+                    tail->next = expected;
+                } while (!remote.compare_exchange_weak(expected, head, std::memory_order_release, std::memory_order_relaxed));
+            }
+
+            void drain_remote() noexcept {
+                if (remote.load(std::memory_order_relaxed) == nullptr) {
+                    return;
+                }
+
+                free_block* block = remote.exchange(nullptr, std::memory_order_acquire);
+                while (block != nullptr) {
+                    free_block* next = block->next;
+                    push_local(block, header_of(block)->size_class);
+                    block = next;
+                }
+            }
+
+            void flush(pending_batch& batch) noexcept {
+                if (batch.count != 0) {
+                    batch.owner->give_back(batch.head, batch.tail);
+                    bump(remote_batches);
+                    pending_count -= batch.count;
+                }
+                batch = pending_batch{};
+            }
+
+            void flush_pending() noexcept {
+                if (pending_count != 0) {
+                    for (pending_batch& batch : pending) {
+                        flush(batch);
+                    }
+                }
+            }
+
+            void flush_stale_pending() noexcept {
+                if (pending_count != 0 && deallocations.load(std::memory_order_relaxed) - pending_since >= remote_flush_interval) {
+                    flush_pending();
+                }
+            }
+
+            void defer_remote(thread_cache* owner, free_block* block) noexcept {
+                bump(remote_frees);
+                if (pending_count++ == 0) {
+                    pending_since = deallocations.load(std::memory_order_relaxed);
+                }
+
+                pending_batch& batch = pending[(reinterpret_cast<std::uintptr_t>(owner) / alignof(thread_cache)) % pending_slots];
+                if (batch.owner != owner) {
+                    flush(batch);
+                    batch.owner = owner;
+                    batch.tail = block;
+                }
+
+                block->next = batch.head;
+                batch.head = block;
+                if (++batch.count >= remote_batch_size) {
+                    flush(batch);
+                }
+            }
+
+            // Called when the owning thread exits: hands back pending remote frees and returns every
+            // cached block to the system. The cache itself stays alive for blocks still in use.
+            void release() noexcept {
+                flush_pending();
+
+                free_block* block = remote.exchange(&orphan_mark, std::memory_order_acquire);
+                while (block != nullptr) {
+                    free_block* next = block->next;
+                    ::operator delete(header_of(block));
+                    block = next;
+                }
+                for (std::uint32_t size_class = 0; size_class < class_count; ++size_class) {
+                    while (free_block* block = pop_local(size_class)) {
+                        ::operator delete(header_of(block));
+                    }
+                }
+            }
+        };
+
+        // Thread caches are never destroyed: blocks may outlive the thread that allocated them, so a
+        // cache whose thread exited is parked as an orphan and adopted by the next new thread.
+        struct registry {
+            std::mutex mutex;
+            vector<thread_cache*> caches;
+            vector<thread_cache*> orphans;
+        };
+
+        inline registry& global_registry() {
+            // Leaked on purpose so it outlives thread_local and static destructors that still free blocks.
+            static registry* instance = new registry();
+            return *instance;
+        }
+
+        inline thread_local bool thread_cache_released = false;
+
+        struct cache_handle {
+            thread_cache* cache = nullptr;
+
+            cache_handle() {
+                registry& shared = global_registry();
+                std::lock_guard<std::mutex> lock(shared.mutex);
+
+                if (!shared.orphans.empty()) {
+                    cache = shared.orphans.back();
+                    shared.orphans.pop_back();
+                    // Nothing pushes onto an orphan's remote list, so a plain store ends the orphan state.
+                    cache->remote.store(nullptr, std::memory_order_relaxed);
+                }
+                else {
+                    cache = new thread_cache();
+                    shared.caches.push_back(cache);
+                }
+            }
+
+            ~cache_handle() {
+                cache->release();
+                thread_cache_released = true;
+
+                registry& shared = global_registry();
+                std::lock_guard<std::mutex> lock(shared.mutex);
+                shared.orphans.push_back(cache);
+            }
+        };
+
+        // The calling thread's cache, or nullptr while the thread is shutting down.
+        inline thread_cache* current_cache() {
+            if (thread_cache_released) {
+                return nullptr;
+            }
+
+            thread_local cache_handle handle;
+            return handle.cache;
+        }
+
+        inline void* allocate(const std::size_t bytes) {
+            const std::uint32_t size_class = size_class_of(bytes);
+            thread_cache* cache = current_cache();
+
+            if (cache != nullptr) {
+                bump(cache->allocations);
+
+                if (size_class != uncached) {
+                    free_block* block = cache->pop_local(size_class);
+                    if (block == nullptr) {
+                        cache->flush_pending();
+                        cache->drain_remote();
+                        block = cache->pop_local(size_class);
+                    }
+
+                    if (block != nullptr) {
+                        bump(cache->cache_hits);
+                        return block;
+                    }
+                }
+
+                bump(cache->system_allocations);
+            }
+
+            const std::size_t payload = size_class == uncached ? bytes : class_bytes(size_class);
+            void* raw = ::operator new(header_size + payload);
+
+            thread_cache* owner = size_class == uncached ? nullptr : cache;
+            ::new (raw) header{owner, size_class};
+
+            return static_cast<char*>(raw) + header_size;
+        }
+
+        inline void deallocate(void* payload) noexcept {
+            header* block_header = header_of(payload);
+            thread_cache* cache = current_cache();
+            free_block* block = static_cast<free_block*>(payload);
+
+            if (cache != nullptr) {
+                bump(cache->deallocations);
+            }
+
+            if (block_header->owner == nullptr) {
+                ::operator delete(block_header);
+            }
+            else if (block_header->owner == cache) {
+                cache->push_local(block, block_header->size_class);
+            }
+            else if (cache != nullptr) {
+                cache->defer_remote(block_header->owner, block);
+            }
+            else {
+                block_header->owner->give_back(block, block);
+            }
+
+            if (cache != nullptr) {
+                cache->flush_stale_pending();
+            }
+        }
+    }
+
+    // Hands the calling thread's pending remote frees back to their owners now, e.g. before the
+    // thread goes idle for a long time.
+    inline void pool_flush() {
+        if (detail::pool::thread_cache* cache = detail::pool::current_cache()) {
+            cache->flush_pending();
+        }
+    }
+
+    inline pool_stats pool_statistics() {
+        detail::pool::registry& shared = detail::pool::global_registry();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+
+        pool_stats total;
+        for (std::size_t i = 0; i < shared.caches.size(); ++i) {
+            const detail::pool::thread_cache& cache = *shared.caches[i];
+            total.allocations += cache.allocations.load(std::memory_order_relaxed);
+            total.deallocations += cache.deallocations.load(std::memory_order_relaxed);
+            total.cache_hits += cache.cache_hits.load(std::memory_order_relaxed);
+            total.system_allocations += cache.system_allocations.load(std::memory_order_relaxed);
+            total.remote_frees += cache.remote_frees.load(std::memory_order_relaxed);
+            total.remote_batches += cache.remote_batches.load(std::memory_order_relaxed);
+            total.cached_bytes += cache.cached_bytes.load(std::memory_order_relaxed);
+        }
+
+        return total;
+    }
+
+    // Stateless allocator over per-thread caches of power-of-two size classes. Freeing a block on
+    // any thread is allowed; blocks from another thread's cache go back to it in batches.
+    template <typename T>
+    class pool_allocator {
+        static_assert(alignof(T) <= detail::pool::header_size, "pool_allocator does not support over-aligned types");
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        using propagate_on_container_move_assignment = std::true_type;
+        using is_always_equal = std::true_type;
+
+        pool_allocator() noexcept = default;
+
+        template <typename U>
+        pool_allocator(const pool_allocator<U>&) noexcept {}
+
+        [[nodiscard]] T* allocate(const size_type n) {
+            if (n > max_size()) {
+                NP_VECTOR_THROW(std::bad_array_new_length());
+            }
+
+            return static_cast<T*>(detail::pool::allocate(n * sizeof(T)));
+        }
+
+        void deallocate(T* ptr, size_type) noexcept {
+            detail::pool::deallocate(ptr);
+        }
+
+        [[nodiscard]] static constexpr size_type max_size() noexcept {
+            return (std::numeric_limits<size_type>::max() - detail::pool::header_size) / sizeof(T);
+        }
+
+        template <typename U>
+        bool operator==(const pool_allocator<U>&) const noexcept {
+            return true;
+        }
+    };
+}
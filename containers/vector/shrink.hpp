@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace np {
+    // Opt-in automatic shrinking for np::vector. After an operation that removes elements, a vector
+    // whose size fell below capacity / shrink_below reallocates to size * keep_factor. Between the two
+    // thresholds neither growing nor shrinking reallocates, so a size that oscillates doesn't thrash.
+    struct shrink_policy {
+        std::size_t shrink_below = 4;
+        std::size_t keep_factor = 2;
+        std::size_t min_capacity_bytes = 4096;  // buffers this small are never shrunk
+    };
+
+    class trim_registry;
+
+    namespace detail {
+        // Intrusive list entry that a tracked container embeds. trim releases the container's spare
+        // capacity and returns the number of bytes freed.
+        struct trim_node {
+            trim_node* prev = nullptr;
+            trim_node* next = nullptr;
+            trim_registry* registry = nullptr;
+            std::size_t (*trim)(trim_node&) = nullptr;
+            std::uint64_t seen_epoch = 0;  // registry epoch this member last trimmed for
+
+            trim_node() = default;
+            trim_node(const trim_node&) = delete;
+            trim_node& operator=(const trim_node&) = delete;
+
+            inline void leave();
+
+            ~trim_node() {
+                leave();
+            }
+        };
+    }
+
+    // Set of containers that can be trimmed to their size, e.g. under memory pressure.
+    // request_trim() only bumps an epoch and is safe from any thread and from signal handlers. Each
+    // member notices the new epoch on the thread that uses it: on its next pop_back, erase, clear or
+    // shrinking resize, or when its owner calls trim_if_requested() on it. The registry never touches
+    // a member's buffer for a request, so the shared global() registry works with vectors in use on
+    // many threads.
+    // trim() instead trims every member immediately from the calling thread. Only call it where no
+    // member can be in use by another thread, e.g. on a registry private to one thread.
+    class trim_registry {
+        std::mutex mutex_;
+        detail::trim_node* first_ = nullptr;
+        std::size_t count_ = 0;
+        std::atomic<std::uint64_t> epoch_{0};
+
+        friend struct detail::trim_node;
+
+        void unlink(detail::trim_node& node) noexcept {
+            if (node.prev != nullptr) {
+                node.prev->next = node.next;
+            }
+            else {
+                first_ = node.next;
+            }
+            if (node.next != nullptr) {
+                node.next->prev = node.prev;
+            }
+
+            node.prev = nullptr;
+            node.next = nullptr;
+            node.registry = nullptr;
+            --count_;
+        }
+
+    public:
+        trim_registry() = default;
+        trim_registry(const trim_registry&) = delete;
+        trim_registry& operator=(const trim_registry&) = delete;
+
+        // The registry vector::track() uses by default.
+        static trim_registry& global() {
+            static trim_registry instance;
+            return instance;
+        }
+
+        void add(detail::trim_node& node) {
+            node.leave();
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            node.registry = this;
+            node.seen_epoch = epoch_.load(std::memory_order_relaxed);
+            node.prev = nullptr;
+            node.next = first_;
+            if (first_ != nullptr) {
+                first_->prev = &node;
+            }
+            first_ = &node;
+            ++count_;
+        }
+
+        // Trims every member to its size now; returns the bytes released. See the class comment.
+        std::size_t trim() {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            std::size_t released = 0;
+            for (detail::trim_node* node = first_; node != nullptr; node = node->next) {
+                released += node->trim(*node);
+            }
+            return released;
+        }
+
+        // Asks every member to trim itself on its own thread.
+        void request_trim() noexcept {
+            epoch_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] std::uint64_t epoch() const noexcept {
+            return epoch_.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] std::size_t size() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return count_;
+        }
+
+        ~trim_registry() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            while (first_ != nullptr) {
+                unlink(*first_);
+            }
+        }
+    };
+
+    inline void detail::trim_node::leave() {
+        if (registry != nullptr) {
+            std::lock_guard<std::mutex> lock(registry->mutex_);
+            registry->unlink(*this);
+        }
+    }
+}
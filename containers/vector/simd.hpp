@@ -0,0 +1,463 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "exceptions.hpp"
+
+// The vector kernels are compiled per instruction set under #pragma GCC target, which clang
+// ignores; clang builds use the scalar kernels.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(__clang__)
+#define NP_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+// Numeric kernels over contiguous ranges of arithmetic values (np::vector, std::span, ...).
+// float and double have hand-written SSE2 / AVX2 / AVX-512 paths selected at runtime from cpuid.
+// 32- and 64-bit integers have them for sum, find and count; their other kernels, every other
+// arithmetic type, every non-x86 build and clang builds use the scalar kernels.
+// Reductions over floating-point values are computed in a different order than a sequential loop,
+// so results may differ from it in the last bits. min_max and clamp treat NaN like std::min and
+// std::max on every instruction set: min_max ignores NaNs unless the first element is one, in which
+// case both results are NaN, and clamp leaves a NaN element unchanged.
+namespace np::simd {
+    enum class isa {
+        scalar,
+        sse2,
+        avx2,
+        avx512
+    };
+
+    namespace detail {
+        inline isa detect_isa() noexcept {
+#if defined(NP_SIMD_X86)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) {
+                return isa::avx512;
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                return isa::avx2;
+            }
+            if (__builtin_cpu_supports("sse2")) {
+                return isa::sse2;
+            }
+#endif
+            return isa::scalar;
+        }
+
+        inline std::atomic<isa>& active_isa_storage() noexcept {
+            static std::atomic<isa> active(detect_isa());
+            return active;
+        }
+
+        template <typename T>
+        inline constexpr bool has_vector_kernels = std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+        // Integers only need add and compare for sum, find and count. Their other kernels stay scalar:
+        // SSE2 has no 32-bit and AVX2 no 64-bit multiply, min or max.
+        template <typename T>
+        inline constexpr bool has_vector_integer_kernels = std::is_integral_v<T> && !std::is_same_v<T, bool> && (sizeof(T) == 4 || sizeof(T) == 8);
+
+        namespace scalar {
+            template <typename T>
+            struct kernels {
+                static T sum(const T* data, const std::size_t n) {
+                    T result = T(0);
+                    for (std::size_t i = 0; i < n; ++i) {
+                        result += data[i];
+                    }
+                    return result;
+                }
+
+                static T dot(const T* lhs, const T* rhs, const std::size_t n) {
+                    T result = T(0);
+                    for (std::size_t i = 0; i < n; ++i) {
+                        result += lhs[i] * rhs[i];
+                    }
+                    return result;
+                }
+
+                static std::pair<T, T> min_max(const T* data, const std::size_t n) {
+                    std::pair<T, T> result(data[0], data[0]);
+                    for (std::size_t i = 1; i < n; ++i) {
+                        result.first = std::min(result.first, data[i]);
+                        result.second = std::max(result.second, data[i]);
+                    }
+                    return result;
+                }
+
+                static std::size_t find(const T* data, const std::size_t n, const T value) {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        if (data[i] == value) {
+                            return i;
+                        }
+                    }
+                    return n;
+                }
+
+                static std::size_t count(const T* data, const std::size_t n, const T value) {
+                    std::size_t result = 0;
+                    for (std::size_t i = 0; i < n; ++i) {
+                        result += data[i] == value;
+                    }
+                    return result;
+                }
+
+                static void scale(T* data, const std::size_t n, const T factor) {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        data[i] *= factor;
+                    }
+                }
+
+                static void axpy(const T alpha, const T* x, T* y, const std::size_t n) {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        y[i] += alpha * x[i];
+                    }
+                }
+
+                static void clamp(T* data, const std::size_t n, const T lo, const T hi) {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        data[i] = std::min(std::max(data[i], lo), hi);
+                    }
+                }
+            };
+        }
+
+#if defined(NP_SIMD_X86)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+        namespace sse2 {
+            template <typename T>
+            struct ops;
+
+            template <>
+            struct ops<float> {
+                using reg = __m128;
+                static constexpr std::size_t width = 4;
+
+                static reg load(const float* ptr) { return _mm_loadu_ps(ptr); }
+                static void store(float* ptr, const reg value) { _mm_storeu_ps(ptr, value); }
+                static reg set1(const float value) { return _mm_set1_ps(value); }
+                static reg add(const reg lhs, const reg rhs) { return _mm_add_ps(lhs, rhs); }
+                static reg mul(const reg lhs, const reg rhs) { return _mm_mul_ps(lhs, rhs); }
+                static reg min(const reg lhs, const reg rhs) { return _mm_min_ps(lhs, rhs); }
+                static reg max(const reg lhs, const reg rhs) { return _mm_max_ps(lhs, rhs); }
+                static std::uint32_t eq_mask(const reg lhs, const reg rhs) { return static_cast<std::uint32_t>(_mm_movemask_ps(_mm_cmpeq_ps(lhs, rhs))); }
+            };
+
+            template <>
+            struct ops<double> {
+                using reg = __m128d;
+                static constexpr std::size_t width = 2;
+
+                static reg load(const double* ptr) { return _mm_loadu_pd(ptr); }
+                static void store(double* ptr, const reg value) { _mm_storeu_pd(ptr, value); }
+                static reg set1(const double value) { return _mm_set1_pd(value); }
+                static reg add(const reg lhs, const reg rhs) { return _mm_add_pd(lhs, rhs); }
+                static reg mul(const reg lhs, const reg rhs) { return _mm_mul_pd(lhs, rhs); }
+                static reg min(const reg lhs, const reg rhs) { return _mm_min_pd(lhs, rhs); }
+                static reg max(const reg lhs, const reg rhs) { return _mm_max_pd(lhs, rhs); }
+                static std::uint32_t eq_mask(const reg lhs, const reg rhs) { return static_cast<std::uint32_t>(_mm_movemask_pd(_mm_cmpeq_pd(lhs, rhs))); }
+            };
+
+            template <typename T>
+                requires(has_vector_integer_kernels<T> && sizeof(T) == 4)
+            struct ops<T> {
+                using reg = __m128i;
+                static constexpr std::size_t width = 4;
+
+                static reg load(const T* ptr) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)); }
+                static void store(T* ptr, const reg value) { _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), value); }
+                static reg set1(const T value) { return _mm_set1_epi32(static_cast<int>(value)); }
+                static reg add(const reg lhs, const reg rhs) { return _mm_add_epi32(lhs, rhs); }
+                static std::uint32_t eq_mask(const reg lhs, const reg rhs) { return static_cast<std::uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(lhs, rhs)))); }
+            };
+
+            template <typename T>
+                requires(has_vector_integer_kernels<T> && sizeof(T) == 8)
+            struct ops<T> {
+                using reg = __m128i;
+                static constexpr std::size_t width = 2;
+
+                static reg load(const T* ptr) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)); }
+                static void store(T* ptr, const reg value) { _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), value); }
+                static reg set1(const T value) { return _mm_set1_epi64x(static_cast<long long>(value)); }
+                static reg add(const reg lhs, const reg rhs) { return _mm_add_epi64(lhs, rhs); }
+
+                // SSE2 has no 64-bit compare: both 32-bit halves have to match.
+                static std::uint32_t eq_mask(const reg lhs, const reg rhs) {
+                    const reg halves = _mm_cmpeq_epi32(lhs, rhs);
+                    const reg both = _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+                    return static_cast<std::uint32_t>(_mm_movemask_pd(_mm_castsi128_pd(both)));
+                }
+            };
+
+#include "simd_kernels.inl"
+        }
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+        namespace avx2 {
+            template <typename T>
+            struct ops;
+
+            template <>
+            struct ops<float> {
+                using reg = __m256;
+                static constexpr std::size_t width = 8;
+
+                static reg load(const float* ptr) { return _mm256_loadu_ps(ptr); }
+                static void store(float* ptr, const reg value) { _mm256_storeu_ps(ptr, value); }
+                static reg set1(const float value) { return _mm256_set1_ps(value); }
+                static reg add(const reg lhs, const reg rhs) { return _mm256_add_ps(lhs, rhs); }
+                static reg mul(const reg lhs, const reg rhs) { return _mm256_mul_ps(lhs, rhs); }
+                static reg min(const reg lhs, const reg rhs) { return _mm256_min_ps(lhs, rhs); }
+                static reg max(const reg lhs, const reg rhs) { return _mm256_max_ps(lhs, rhs); }
+                static std::uint32_t eq_mask(const reg lhs, const reg rhs) { return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(lhs, rhs, _CMP_EQ_OQ))); }
+            };
+
+            template <>
+            struct ops<double> {
+                using reg = __m256d;
+                static constexpr std::size_t width = 4;
+
+                static reg load(const double* ptr) { return _mm256_loadu_pd(ptr); }
+                static void store(double* ptr, const reg value) { _mm256_storeu_pd(ptr, value); }
+                static reg set1(const double value) { return _mm256_set1_pd(value); }
+                static reg add(const reg lhs, const reg rhs) { return _mm256_add_pd(lhs, rhs); }
+                static reg mul(const reg lhs, const reg rhs) { return _mm256_mul_pd(lhs, rhs); }
+                static reg min(const reg lhs, const reg rhs) { return _mm256_min_pd(lhs, rhs); }
+                static reg max(const reg lhs, const reg rhs) { return _mm256_max_pd(lhs, rhs); }
+                static std::uint32_t eq_mask(const reg lhs, const reg rhs) { return static_cast<std::uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(lhs, rhs, _CMP_EQ_OQ))); }
+            };
+
+            template <typename T>
+                requires(has_vector_integer_kernels<T> && sizeof(T) == 4)
+            struct ops<T> {
+                using reg = __m256i;
+                static constexpr std::size_t width = 8;
+
+                static reg load(const T* ptr) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr)); }
+                static void store(T* ptr, const reg value) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), value); }
+                static reg set1(const T value) { return _mm256_set1_epi32(static_cast<int>(value)); }
+                static reg add(const reg lhs, const reg rhs) { return _mm256_add_epi32(lhs, rhs); }
+                static std::uint32_t eq_mask(const reg lhs, const reg rhs) { return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(lhs, rhs)))); }
+            };
+
+            template <typename T>
+                requires(has_vector_integer_kernels<T> && sizeof(T) == 8)
+            struct ops<T> {
+                using reg = __m256i;
+                static constexpr std::size_t width = 4;
+
+                static reg load(const T* ptr) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr)); }
+                static void store(T* ptr, const reg value) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), value); }
+                static reg set1(const T value) { return _mm256_set1_epi64x(static_cast<long long>(value)); }
+                static reg add(const reg lhs, const reg rhs) { return _mm256_add_epi64(lhs, rhs); }
+                static std::uint32_t eq_mask(const reg lhs, const reg rhs) { return static_cast<std::uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(lhs, rhs)))); }
+            };
+
+#include "simd_kernels.inl"
+        }
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+        namespace avx512 {
+            template <typename T>
+            struct ops;
+
+            template <>
+            struct ops<float> {
+                using reg = __m512;
+                static constexpr std::size_t width = 16;
+
+                static reg load(const float* ptr) { return _mm512_loadu_ps(ptr); }
+                static void store(float* ptr, const reg value) { _mm512_storeu_ps(ptr, value); }
+                static reg set1(const float value) { return _mm512_set1_ps(value); }
+                static reg add(const reg lhs, const reg rhs) { return _mm512_add_ps(lhs, rhs); }
+                static reg mul(const reg lhs, const reg rhs) { return _mm512_mul_ps(lhs, rhs); }
+                // The masked forms with an all-ones mask are the same instruction; the unmasked ones pass
+                // GCC 12 an uninitialized source register and trip -Wmaybe-uninitialized.
+                static reg min(const reg lhs, const reg rhs) { return _mm512_mask_min_ps(lhs, __mmask16(0xFFFF), lhs, rhs); }
+                static reg max(const reg lhs, const reg rhs) { return _mm512_mask_max_ps(lhs, __mmask16(0xFFFF), lhs, rhs); }
+                static std::uint32_t eq_mask(const reg lhs, const reg rhs) { return static_cast<std::uint32_t>(_mm512_cmp_ps_mask(lhs, rhs, _CMP_EQ_OQ)); }
+            };
+
+            template <>
+            struct ops<double> {
+                using reg = __m512d;
+                static constexpr std::size_t width = 8;
+
+                static reg load(const double* ptr) { return _mm512_loadu_pd(ptr); }
+                static void store(double* ptr, const reg value) { _mm512_storeu_pd(ptr, value); }
+                static reg set1(const double value) { return _mm512_set1_pd(value); }
+                static reg add(const reg lhs, const reg rhs) { return _mm512_add_pd(lhs, rhs); }
+                static reg mul(const reg lhs, const reg rhs) { return _mm512_mul_pd(lhs, rhs); }
+                static reg min(const reg lhs, const reg rhs) { return _mm512_mask_min_pd(lhs, __mmask8(0xFF), lhs, rhs); }
+                static reg max(const reg lhs, const reg rhs) { return _mm512_mask_max_pd(lhs, __mmask8(0xFF), lhs, rhs); }
+                static std::uint32_t eq_mask(const reg lhs, const reg rhs) { return static_cast<std::uint32_t>(_mm512_cmp_pd_mask(lhs, rhs, _CMP_EQ_OQ)); }
+            };
+
+            template <typename T>
+                requires(has_vector_integer_kernels<T> && sizeof(T) == 4)
+            struct ops<T> {
+                using reg = __m512i;
+                static constexpr std::size_t width = 16;
+
+                static reg load(const T* ptr) { return _mm512_loadu_si512(ptr); }
+                static void store(T* ptr, const reg value) { _mm512_storeu_si512(ptr, value); }
+                static reg set1(const T value) { return _mm512_set1_epi32(static_cast<int>(value)); }
+                static reg add(const reg lhs, const reg rhs) { return _mm512_add_epi32(lhs, rhs); }
+                static std::uint32_t eq_mask(const reg lhs, const reg rhs) { return static_cast<std::uint32_t>(_mm512_cmpeq_epi32_mask(lhs, rhs)); }
+            };
+
+            template <typename T>
+                requires(has_vector_integer_kernels<T> && sizeof(T) == 8)
+            struct ops<T> {
+                using reg = __m512i;
+                static constexpr std::size_t width = 8;
+
+                static reg load(const T* ptr) { return _mm512_loadu_si512(ptr); }
+                static void store(T* ptr, const reg value) { _mm512_storeu_si512(ptr, value); }
+                static reg set1(const T value) { return _mm512_set1_epi64(static_cast<long long>(value)); }
+                static reg add(const reg lhs, const reg rhs) { return _mm512_add_epi64(lhs, rhs); }
+                static std::uint32_t eq_mask(const reg lhs, const reg rhs) { return static_cast<std::uint32_t>(_mm512_cmpeq_epi64_mask(lhs, rhs)); }
+            };
+
+#include "simd_kernels.inl"
+        }
+#pragma GCC pop_options
+#endif
+
+        // Calls kernel with the kernels<T> of the active instruction set, or the scalar ones unless
+        // vectorized.
+        template <typename T, bool vectorized = has_vector_kernels<T>, typename Kernel>
+        decltype(auto) dispatch(Kernel&& kernel) {
+#if defined(NP_SIMD_X86)
+            if constexpr (vectorized) {
+                switch (active_isa_storage().load(std::memory_order_relaxed)) {
+                    case isa::avx512:
+                        return kernel(avx512::kernels<T>{});
+                    case isa::avx2:
+                        return kernel(avx2::kernels<T>{});
+                    case isa::sse2:
+                        return kernel(sse2::kernels<T>{});
+                    case isa::scalar:
+                        break;
+                }
+            }
+#endif
+            return kernel(scalar::kernels<T>{});
+        }
+
+        template <typename T, typename Kernel>
+        decltype(auto) dispatch_lookup(Kernel&& kernel) {
+            return dispatch<T, has_vector_kernels<T> || has_vector_integer_kernels<T>>(std::forward<Kernel>(kernel));
+        }
+
+        template <typename Range>
+        using element_t = std::ranges::range_value_t<Range>;
+
+        template <typename Range>
+        concept arithmetic_range = std::ranges::contiguous_range<Range> && std::ranges::sized_range<Range> && std::is_arithmetic_v<element_t<Range>>;
+
+        template <typename Range>
+        concept mutable_arithmetic_range = arithmetic_range<Range> && !std::is_const_v<std::remove_reference_t<std::ranges::range_reference_t<Range>>>;
+    }
+
+    // Best instruction set supported by the running CPU.
+    inline isa supported_isa() noexcept {
+        static const isa supported = detail::detect_isa();
+        return supported;
+    }
+
+    // Instruction set the kernels currently dispatch to.
+    inline isa active_isa() noexcept {
+        return detail::active_isa_storage().load(std::memory_order_relaxed);
+    }
+
+    // Restricts dispatch to at most the given instruction set (clamped to what the CPU supports).
+    inline void set_active_isa(const isa level) noexcept {
+        detail::active_isa_storage().store(std::min(level, supported_isa()), std::memory_order_relaxed);
+    }
+
+    template <detail::arithmetic_range Range>
+    detail::element_t<Range> sum(const Range& values) {
+        using T = detail::element_t<Range>;
+        return detail::dispatch_lookup<T>([&](auto kernels) { return kernels.sum(std::ranges::data(values), std::ranges::size(values)); });
+    }
+
+    template <detail::arithmetic_range Range>
+    std::pair<detail::element_t<Range>, detail::element_t<Range>> min_max(const Range& values) {
+        using T = detail::element_t<Range>;
+        if (std::ranges::empty(values)) {
+            NP_VECTOR_THROW(std::out_of_range("min_max of an empty range"));
+        }
+
+        return detail::dispatch<T>([&](auto kernels) { return kernels.min_max(std::ranges::data(values), std::ranges::size(values)); });
+    }
+
+    template <detail::arithmetic_range Lhs, detail::arithmetic_range Rhs>
+        requires std::is_same_v<detail::element_t<Lhs>, detail::element_t<Rhs>>
+    detail::element_t<Lhs> dot(const Lhs& lhs, const Rhs& rhs) {
+        using T = detail::element_t<Lhs>;
+        if (std::ranges::size(lhs) != std::ranges::size(rhs)) {
+            NP_VECTOR_THROW(std::invalid_argument("dot of ranges with different sizes"));
+        }
+
+        return detail::dispatch<T>([&](auto kernels) { return kernels.dot(std::ranges::data(lhs), std::ranges::data(rhs), std::ranges::size(lhs)); });
+    }
+
+    // Index of the first element equal to value, or the size of the range if there is none.
+    template <detail::arithmetic_range Range>
+    std::size_t find(const Range& values, const detail::element_t<Range> value) {
+        using T = detail::element_t<Range>;
+        return detail::dispatch_lookup<T>([&](auto kernels) { return kernels.find(std::ranges::data(values), std::ranges::size(values), value); });
+    }
+
+    template <detail::arithmetic_range Range>
+    std::size_t count(const Range& values, const detail::element_t<Range> value) {
+        using T = detail::element_t<Range>;
+        return detail::dispatch_lookup<T>([&](auto kernels) { return kernels.count(std::ranges::data(values), std::ranges::size(values), value); });
+    }
+
+    // values[i] *= factor
+    template <detail::mutable_arithmetic_range Range>
+    void scale(Range&& values, const detail::element_t<Range> factor) {
+        using T = detail::element_t<Range>;
+        detail::dispatch<T>([&](auto kernels) { kernels.scale(std::ranges::data(values), std::ranges::size(values), factor); });
+    }
+
+    // y[i] += alpha * x[i]
+    template <detail::arithmetic_range X, detail::mutable_arithmetic_range Y>
+        requires std::is_same_v<detail::element_t<X>, detail::element_t<Y>>
+    void axpy(const detail::element_t<X> alpha, const X& x, Y&& y) {
+        using T = detail::element_t<X>;
+        if (std::ranges::size(x) != std::ranges::size(y)) {
+            NP_VECTOR_THROW(std::invalid_argument("axpy of ranges with different sizes"));
+        }
+
+        detail::dispatch<T>([&](auto kernels) { kernels.axpy(alpha, std::ranges::data(x), std::ranges::data(y), std::ranges::size(x)); });
+    }
+
+    // values[i] = min(max(values[i], lo), hi)
+    template <detail::mutable_arithmetic_range Range>
+    void clamp(Range&& values, const detail::element_t<Range> lo, const detail::element_t<Range> hi) {
+        using T = detail::element_t<Range>;
+        if (hi < lo) {
+            NP_VECTOR_THROW(std::invalid_argument("clamp with hi < lo"));
+        }
+
+        detail::dispatch<T>([&](auto kernels) { kernels.clamp(std::ranges::data(values), std::ranges::size(values), lo, hi); });
+    }
+}
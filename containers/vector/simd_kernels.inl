@@ -0,0 +1,177 @@
+// Instruction-set independent kernel bodies. simd.hpp includes this file once per instruction set,
+// inside a namespace that provides ops<T> and under the matching target pragma, so every kernel is
+// compiled for that instruction set only. Do not include it directly.
+
+template <typename T>
+struct kernels {
+    using V = ops<T>;
+    using reg = typename V::reg;
+
+    static constexpr std::size_t width = V::width;
+
+    static T sum(const T* data, const std::size_t n) {
+        reg acc0 = V::set1(T(0));
+        reg acc1 = acc0;
+        reg acc2 = acc0;
+        reg acc3 = acc0;
+
+        std::size_t i = 0;
+        for (; i + 4 * width <= n; i += 4 * width) {
+            acc0 = V::add(acc0, V::load(data + i));
+            acc1 = V::add(acc1, V::load(data + i + width));
+            acc2 = V::add(acc2, V::load(data + i + 2 * width));
+            acc3 = V::add(acc3, V::load(data + i + 3 * width));
+        }
+        for (; i + width <= n; i += width) {
+            acc0 = V::add(acc0, V::load(data + i));
+        }
+
+        T result = reduce_add(V::add(V::add(acc0, acc1), V::add(acc2, acc3)));
+        for (; i < n; ++i) {
+            result += data[i];
+        }
+
+        return result;
+    }
+
+    static T dot(const T* lhs, const T* rhs, const std::size_t n) {
+        reg acc0 = V::set1(T(0));
+        reg acc1 = acc0;
+        reg acc2 = acc0;
+        reg acc3 = acc0;
+
+        std::size_t i = 0;
+        for (; i + 4 * width <= n; i += 4 * width) {
+            acc0 = V::add(acc0, V::mul(V::load(lhs + i), V::load(rhs + i)));
+            acc1 = V::add(acc1, V::mul(V::load(lhs + i + width), V::load(rhs + i + width)));
+            acc2 = V::add(acc2, V::mul(V::load(lhs + i + 2 * width), V::load(rhs + i + 2 * width)));
+            acc3 = V::add(acc3, V::mul(V::load(lhs + i + 3 * width), V::load(rhs + i + 3 * width)));
+        }
+        for (; i + width <= n; i += width) {
+            acc0 = V::add(acc0, V::mul(V::load(lhs + i), V::load(rhs + i)));
+        }
+
+        T result = reduce_add(V::add(V::add(acc0, acc1), V::add(acc2, acc3)));
+        for (; i < n; ++i) {
+            result += lhs[i] * rhs[i];
+        }
+
+        return result;
+    }
+
+    static std::pair<T, T> min_max(const T* data, const std::size_t n) {
+        reg lo = V::set1(data[0]);
+        reg hi = lo;
+
+        std::size_t i = 0;
+        // min/max instructions return their second operand when either is NaN, std::min/std::max
+        // their first; passing the accumulator second makes every instruction set agree with the
+        // scalar kernels.
+        for (; i + width <= n; i += width) {
+            const reg value = V::load(data + i);
+            lo = V::min(value, lo);
+            hi = V::max(value, hi);
+        }
+
+        alignas(64) T lo_lanes[width];
+        alignas(64) T hi_lanes[width];
+        V::store(lo_lanes, lo);
+        V::store(hi_lanes, hi);
+
+        std::pair<T, T> result(lo_lanes[0], hi_lanes[0]);
+        for (std::size_t lane = 1; lane < width; ++lane) {
+            result.first = std::min(result.first, lo_lanes[lane]);
+            result.second = std::max(result.second, hi_lanes[lane]);
+        }
+        for (; i < n; ++i) {
+            result.first = std::min(result.first, data[i]);
+            result.second = std::max(result.second, data[i]);
+        }
+
+        return result;
+    }
+
+    static std::size_t find(const T* data, const std::size_t n, const T value) {
+        const reg needle = V::set1(value);
+
+        std::size_t i = 0;
+        for (; i + width <= n; i += width) {
+            const std::uint32_t mask = V::eq_mask(V::load(data + i), needle);
+            if (mask != 0) {
+                return i + static_cast<std::size_t>(std::countr_zero(mask));
+            }
+        }
+        for (; i < n; ++i) {
+            if (data[i] == value) {
+                return i;
+            }
+        }
+
+        return n;
+    }
+
+    static std::size_t count(const T* data, const std::size_t n, const T value) {
+        const reg needle = V::set1(value);
+
+        std::size_t result = 0;
+        std::size_t i = 0;
+        for (; i + width <= n; i += width) {
+            result += static_cast<std::size_t>(std::popcount(V::eq_mask(V::load(data + i), needle)));
+        }
+        for (; i < n; ++i) {
+            result += data[i] == value;
+        }
+
+        return result;
+    }
+
+    static void scale(T* data, const std::size_t n, const T factor) {
+        const reg scalar = V::set1(factor);
+
+        std::size_t i = 0;
+        for (; i + width <= n; i += width) {
+            V::store(data + i, V::mul(V::load(data + i), scalar));
+        }
+        for (; i < n; ++i) {
+            data[i] *= factor;
+        }
+    }
+
+    static void axpy(const T alpha, const T* x, T* y, const std::size_t n) {
+        const reg scalar = V::set1(alpha);
+
+        std::size_t i = 0;
+        for (; i + width <= n; i += width) {
+            V::store(y + i, V::add(V::mul(scalar, V::load(x + i)), V::load(y + i)));
+        }
+        for (; i < n; ++i) {
+            y[i] += alpha * x[i];
+        }
+    }
+
+    static void clamp(T* data, const std::size_t n, const T lo, const T hi) {
+        const reg lower = V::set1(lo);
+        const reg upper = V::set1(hi);
+
+        std::size_t i = 0;
+        for (; i + width <= n; i += width) {
+            V::store(data + i, V::min(upper, V::max(lower, V::load(data + i))));
+        }
+        for (; i < n; ++i) {
+            data[i] = std::min(std::max(data[i], lo), hi);
+        }
+    }
+
+private:
+    static T reduce_add(const reg value) {
+        alignas(64) T lanes[width];
+        V::store(lanes, value);
+
+        T result = lanes[0];
+        for (std::size_t lane = 1; lane < width; ++lane) {
+            result += lanes[lane];
+        }
+
+        return result;
+    }
+};
@@ -0,0 +1,541 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <latch>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "exceptions.hpp"
+#include "execution.hpp"
+#include "vector.hpp"
+
+// np::sort and np::sort_by_key. Integral and IEEE floating-point keys go through an LSD radix sort
+// with 8-bit digits; every other key type falls back to std::sort. Floating-point keys are ordered
+// by IEEE totalOrder: -NaN < -inf < ... < -0.0 < +0.0 < ... < +inf < +NaN.
+namespace np {
+    namespace detail::radix {
+        template <typename K>
+        inline constexpr bool sortable_v =
+            (std::is_integral_v<K> && !std::is_same_v<K, bool>) ||
+            (std::is_floating_point_v<K> && std::numeric_limits<K>::is_iec559 && (sizeof(K) == 4 || sizeof(K) == 8));
+
+        template <std::size_t Bytes>
+        struct unsigned_of;
+
+        template <> struct unsigned_of<1> { using type = std::uint8_t; };
+        template <> struct unsigned_of<2> { using type = std::uint16_t; };
+        template <> struct unsigned_of<4> { using type = std::uint32_t; };
+        template <> struct unsigned_of<8> { using type = std::uint64_t; };
+
+        template <typename K>
+        using bits_t = typename unsigned_of<sizeof(K)>::type;
+
+        // Maps a key to an unsigned integer with the same order, so digits can be compared bytewise.
+        template <typename K>
+        bits_t<K> to_bits(const K key) noexcept {
+            using bits = bits_t<K>;
+            constexpr bits sign = bits(1) << (sizeof(K) * 8 - 1);
+
+            const bits raw = std::bit_cast<bits>(key);
+            if constexpr (std::is_floating_point_v<K>) {
+                // Negative values are flipped entirely so that larger magnitudes sort first.
+                return (raw & sign) ? bits(~raw) : bits(raw | sign);
+            }
+            else if constexpr (std::is_signed_v<K>) {
+                return raw ^ sign;
+            }
+            else {
+                return raw;
+            }
+        }
+
+        inline constexpr std::size_t radix = 256;
+        inline constexpr std::size_t insertion_threshold = 64;   // stable insertion sort below this
+        inline constexpr std::size_t comparison_threshold = 1024; // std::sort below this when stability is moot
+
+        using histogram = std::size_t[radix];
+
+        template <typename K>
+        std::size_t digit(const K key, const unsigned pass) noexcept {
+            return static_cast<std::size_t>(to_bits(key) >> (pass * 8)) & (radix - 1);
+        }
+
+        struct no_payload {};
+
+        // Thread-cached scratch buffers larger than this are freed after the sort that needed them.
+        inline constexpr std::size_t max_cached_scratch_bytes = std::size_t(64) << 20;
+
+        // Uninitialized storage for trivially copyable U, grown on demand and kept between uses.
+        template <typename U, typename Allocator>
+        class scratch {
+            using allocator_traits = std::allocator_traits<Allocator>;
+
+            Allocator allocator_;
+            U* data_ = nullptr;
+            std::size_t capacity_ = 0;
+
+        public:
+            scratch() = default;
+
+            explicit scratch(const Allocator& allocator) : allocator_(allocator) {}
+
+            scratch(const scratch&) = delete;
+            scratch& operator=(const scratch&) = delete;
+
+            [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+
+            U* get(const std::size_t n) {
+                if (n > capacity_) {
+                    release();
+                    data_ = std::to_address(allocator_traits::allocate(allocator_, n));
+                    capacity_ = n;
+                }
+
+                return data_;
+            }
+
+            void release() noexcept {
+                if (data_ != nullptr) {
+                    allocator_traits::deallocate(allocator_, data_, capacity_);
+                    data_ = nullptr;
+                    capacity_ = 0;
+                }
+            }
+
+            ~scratch() {
+                release();
+            }
+        };
+
+        // The calling thread's cached scratch buffers form a list, so release_sort_scratch() can free
+        // all of them whatever their element type and allocator.
+        struct cached_buffer {
+            cached_buffer* next = nullptr;
+            void (*release)(cached_buffer&) noexcept = nullptr;
+        };
+
+        inline thread_local cached_buffer* cached_buffers = nullptr;
+
+        template <typename U, typename Allocator>
+        struct cached_scratch_entry : cached_buffer {
+            scratch<U, Allocator> buffer;
+
+            cached_scratch_entry() {
+                release = [](cached_buffer& self) noexcept { static_cast<cached_scratch_entry&>(self).buffer.release(); };
+                next = cached_buffers;
+                cached_buffers = this;
+            }
+
+            ~cached_scratch_entry() {
+                for (cached_buffer** link = &cached_buffers; *link != nullptr; link = &(*link)->next) {
+                    if (*link == this) {
+                        *link = next;
+                        break;
+                    }
+                }
+            }
+        };
+
+        template <typename U, typename Allocator, int Slot>
+        scratch<U, Allocator>& cached_scratch() {
+            thread_local cached_scratch_entry<U, Allocator> cache;
+            return cache.buffer;
+        }
+
+        // Calls f with room for n U's from the container's allocator. Stateless allocators share one
+        // buffer per thread and Slot, so repeated sorts don't allocate; stateful ones allocate per call.
+        // Cached buffers above max_cached_scratch_bytes are freed again afterwards.
+        template <typename U, int Slot, typename Allocator, typename F>
+        void with_scratch(const Allocator& allocator, const std::size_t n, F&& f) {
+            using rebound = typename std::allocator_traits<Allocator>::template rebind_alloc<U>;
+
+            if constexpr (std::allocator_traits<rebound>::is_always_equal::value && std::is_default_constructible_v<rebound>) {
+                struct trim_guard {
+                    scratch<U, rebound>& cache;
+                    ~trim_guard() {
+                        if (cache.capacity() > max_cached_scratch_bytes / sizeof(U)) {
+                            cache.release();
+                        }
+                    }
+                } guard{cached_scratch<U, rebound, Slot>()};
+
+                f(guard.cache.get(n));
+            }
+            else {
+                scratch<U, rebound> local{rebound(allocator)};
+                f(local.get(n));
+            }
+        }
+
+        template <typename K, typename P>
+        void insertion_sort(K* keys, P* payload, const std::size_t n) {
+            for (std::size_t i = 1; i < n; ++i) {
+                const K key = keys[i];
+                const auto bits = to_bits(key);
+
+                std::size_t j = i;
+                if constexpr (std::is_same_v<P, no_payload>) {
+                    for (; j > 0 && to_bits(keys[j - 1]) > bits; --j) {
+                        keys[j] = keys[j - 1];
+                    }
+                }
+                else {
+                    P value = payload[i];
+                    for (; j > 0 && to_bits(keys[j - 1]) > bits; --j) {
+                        keys[j] = keys[j - 1];
+                        payload[j] = payload[j - 1];
+                    }
+                    payload[j] = value;
+                }
+                keys[j] = key;
+            }
+        }
+
+        // A pass is skipped when every key has the same digit in it.
+        inline bool trivial_pass(const histogram& counts, const std::size_t n) noexcept {
+            return std::any_of(counts, counts + radix, [n](const std::size_t count) { return count == n; });
+        }
+
+        // Stable LSD radix sort of keys (and payload alongside), ping-ponging through the scratch arrays.
+        template <typename K, typename P>
+        void sort_serial(K* keys, K* key_scratch, P* payload, P* payload_scratch, const std::size_t n) {
+            constexpr unsigned passes = sizeof(K);
+            constexpr bool has_payload = !std::is_same_v<P, no_payload>;
+
+            histogram counts[passes] = {};
+            for (std::size_t i = 0; i < n; ++i) {
+                const auto bits = to_bits(keys[i]);
+                for (unsigned pass = 0; pass < passes; ++pass) {
+                    ++counts[pass][(bits >> (pass * 8)) & (radix - 1)];
+                }
+            }
+
+            K* src = keys;
+            K* dst = key_scratch;
+            P* payload_src = payload;
+            P* payload_dst = payload_scratch;
+
+            for (unsigned pass = 0; pass < passes; ++pass) {
+                if (trivial_pass(counts[pass], n)) {
+                    continue;
+                }
+
+                std::size_t offsets[radix];
+                std::size_t sum = 0;
+                for (std::size_t bucket = 0; bucket < radix; ++bucket) {
+                    offsets[bucket] = sum;
+                    sum += counts[pass][bucket];
+                }
+
+                for (std::size_t i = 0; i < n; ++i) {
+                    const std::size_t slot = offsets[digit(src[i], pass)]++;
+                    dst[slot] = src[i];
+                    if constexpr (has_payload) {
+                        payload_dst[slot] = payload_src[i];
+                    }
+                }
+
+                std::swap(src, dst);
+                if constexpr (has_payload) {
+                    std::swap(payload_src, payload_dst);
+                }
+            }
+
+            if (src != keys) {
+                std::memcpy(keys, src, n * sizeof(K));
+                if constexpr (has_payload) {
+                    std::memcpy(payload, payload_src, n * sizeof(P));
+                }
+            }
+        }
+
+        // Parallel LSD radix sort. Each worker owns a fixed slice of the source array, counts its digits
+        // into its own histogram, and scatters the slice to offsets derived from all histograms, so the
+        // result is identical to the serial sort.
+        template <typename K, typename P>
+        void sort_parallel(K* keys, K* key_scratch, P* payload, P* payload_scratch, const std::size_t n, const unsigned workers) {
+            constexpr unsigned passes = sizeof(K);
+            constexpr bool has_payload = !std::is_same_v<P, no_payload>;
+
+            std::unique_ptr<histogram[]> counts(new histogram[std::size_t(workers) * passes]);
+            std::barrier<> sync(workers);
+
+            // Workers only start once all of them exist: a worker that can't be created would leave
+            // the others blocked on the barrier forever.
+            std::latch start(1);
+            std::atomic<bool> abandoned{false};
+
+            auto run = [&](const unsigned worker) {
+                const std::size_t begin = n * worker / workers;
+                const std::size_t end = n * (worker + 1) / workers;
+                histogram* mine = &counts[std::size_t(worker) * passes];
+
+                // Whole-array digit counts, used only to decide which passes can be skipped.
+                std::fill_n(&mine[0][0], passes * radix, std::size_t(0));
+                for (std::size_t i = begin; i < end; ++i) {
+                    const auto bits = to_bits(keys[i]);
+                    for (unsigned pass = 0; pass < passes; ++pass) {
+                        ++mine[pass][(bits >> (pass * 8)) & (radix - 1)];
+                    }
+                }
+                sync.arrive_and_wait();
+
+                bool skip[passes];
+                for (unsigned pass = 0; pass < passes; ++pass) {
+                    histogram total = {};
+                    for (unsigned other = 0; other < workers; ++other) {
+                        for (std::size_t bucket = 0; bucket < radix; ++bucket) {
+                            total[bucket] += counts[std::size_t(other) * passes + pass][bucket];
+                        }
+                    }
+                    skip[pass] = trivial_pass(total, n);
+                }
+                sync.arrive_and_wait();
+
+                K* src = keys;
+                K* dst = key_scratch;
+                P* payload_src = payload;
+                P* payload_dst = payload_scratch;
+
+                for (unsigned pass = 0; pass < passes; ++pass) {
+                    if (skip[pass]) {
+                        continue;
+                    }
+
+                    // mine[0] is this worker's histogram for the current pass.
+                    std::fill_n(mine[0], radix, std::size_t(0));
+                    for (std::size_t i = begin; i < end; ++i) {
+                        ++mine[0][digit(src[i], pass)];
+                    }
+                    sync.arrive_and_wait();
+
+                    std::size_t offsets[radix];
+                    std::size_t sum = 0;
+                    for (std::size_t bucket = 0; bucket < radix; ++bucket) {
+                        offsets[bucket] = sum;
+                        for (unsigned other = 0; other < workers; ++other) {
+                            const std::size_t count = counts[std::size_t(other) * passes][bucket];
+                            if (other < worker) {
+                                offsets[bucket] += count;
+                            }
+                            sum += count;
+                        }
+                    }
+
+                    for (std::size_t i = begin; i < end; ++i) {
+                        const std::size_t slot = offsets[digit(src[i], pass)]++;
+                        dst[slot] = src[i];
+                        if constexpr (has_payload) {
+                            payload_dst[slot] = payload_src[i];
+                        }
+                    }
+                    sync.arrive_and_wait();
+
+                    std::swap(src, dst);
+                    if constexpr (has_payload) {
+                        std::swap(payload_src, payload_dst);
+                    }
+                }
+
+                if (src != keys) {
+                    std::memcpy(keys + begin, src + begin, (end - begin) * sizeof(K));
+                    if constexpr (has_payload) {
+                        std::memcpy(payload + begin, payload_src + begin, (end - begin) * sizeof(P));
+                    }
+                }
+            };
+
+            {
+                std::unique_ptr<std::jthread[]> threads(new std::jthread[workers - 1]);
+                NP_VECTOR_TRY {
+                    for (unsigned worker = 1; worker < workers; ++worker) {
+                        threads[worker - 1] = std::jthread([&, worker] {
+                            start.wait();
+                            if (!abandoned.load(std::memory_order_relaxed)) {
+                                run(worker);
+                            }
+                        });
+                    }
+                }
+                NP_VECTOR_CATCH(...) {
+                    // Out of threads or memory: nothing was touched yet, so sort here instead.
+                    abandoned.store(true, std::memory_order_relaxed);
+                }
+
+                start.count_down();
+                if (!abandoned.load(std::memory_order_relaxed)) {
+                    run(0);
+                }
+            }
+
+            if (abandoned.load(std::memory_order_relaxed)) {
+                sort_serial(keys, key_scratch, payload, payload_scratch, n);
+            }
+        }
+
+        template <typename K, typename P>
+        void sort(K* keys, K* key_scratch, P* payload, P* payload_scratch, const std::size_t n, const unsigned workers) {
+            if (workers > 1) {
+                sort_parallel(keys, key_scratch, payload, payload_scratch, n, workers);
+            }
+            else {
+                sort_serial(keys, key_scratch, payload, payload_scratch, n);
+            }
+        }
+
+        // Moves values[order[i]] to position i for every i by following the permutation's cycles.
+        // Consumes order.
+        template <typename V, typename Index>
+        void apply_permutation(V* values, Index* order, const std::size_t n) {
+            for (std::size_t start = 0; start < n; ++start) {
+                if (order[start] == start) {
+                    continue;
+                }
+
+                V held = std::move(values[start]);
+                std::size_t current = start;
+                while (order[current] != start) {
+                    const std::size_t next = order[current];
+                    values[current] = std::move(values[next]);
+                    order[current] = static_cast<Index>(current);
+                    current = next;
+                }
+                values[current] = std::move(held);
+                order[current] = static_cast<Index>(current);
+            }
+        }
+
+        template <typename T>
+        unsigned worker_count(const parallel_policy& policy, const std::size_t n) {
+            return detail::parallel::make_partition<T>(policy, n).workers;
+        }
+
+        template <typename K, typename KeyAllocator, typename V, typename ValueAllocator>
+        void sort_by_key(vector<K, KeyAllocator>& keys, vector<V, ValueAllocator>& values, const unsigned workers) {
+            const std::size_t n = keys.size();
+            K* key_data = std::to_address(keys.data());
+            V* value_data = std::to_address(values.data());
+
+            if constexpr (std::is_trivially_copyable_v<V>) {
+                if (n <= insertion_threshold) {
+                    insertion_sort(key_data, value_data, n);
+                    return;
+                }
+            }
+
+            with_scratch<K, 0>(keys.get_allocator(), n, [&](K* key_scratch) {
+                // Small trivially copyable values travel with their keys; anything else is sorted
+                // through an index permutation and moved into place once at the end.
+                if constexpr (std::is_trivially_copyable_v<V> && sizeof(V) <= 16) {
+                    with_scratch<V, 1>(values.get_allocator(), n, [&](V* value_scratch) {
+                        sort(key_data, key_scratch, value_data, value_scratch, n, workers);
+                    });
+                }
+                else {
+                    auto by_index = [&]<typename Index>(Index) {
+                        with_scratch<Index, 1>(values.get_allocator(), 2 * n, [&](Index* order) {
+                            for (std::size_t i = 0; i < n; ++i) {
+                                order[i] = static_cast<Index>(i);
+                            }
+                            sort(key_data, key_scratch, order, order + n, n, workers);
+                            apply_permutation(value_data, order, n);
+                        });
+                    };
+
+                    if (n <= std::numeric_limits<std::uint32_t>::max()) {
+                        by_index(std::uint32_t{});
+                    }
+                    else {
+                        by_index(std::size_t{});
+                    }
+                }
+            });
+        }
+
+        template <typename T, typename Allocator>
+        void sort(vector<T, Allocator>& vec, const unsigned workers) {
+            const std::size_t n = vec.size();
+            T* data = std::to_address(vec.data());
+
+            if (n < comparison_threshold) {
+                std::sort(data, data + n, [](const T a, const T b) { return to_bits(a) < to_bits(b); });
+                return;
+            }
+
+            with_scratch<T, 0>(vec.get_allocator(), n, [&](T* scratch) {
+                no_payload none;
+                sort(data, scratch, &none, &none, n, workers);
+            });
+        }
+    }
+
+    // Frees the scratch buffers that np::sort and np::sort_by_key keep cached on the calling thread.
+    // Buffers over 64 MiB are never kept; call this after a burst of smaller sorts to give the rest back.
+    inline void release_sort_scratch() noexcept {
+        for (detail::radix::cached_buffer* buffer = detail::radix::cached_buffers; buffer != nullptr; buffer = buffer->next) {
+            buffer->release(*buffer);
+        }
+    }
+
+    // Sorts vec in ascending order. Radix-sortable types don't allocate after the first call on a
+    // thread as long as vec's allocator is stateless.
+    template <typename T, typename Allocator>
+    void sort(vector<T, Allocator>& vec) {
+        if constexpr (detail::radix::sortable_v<T>) {
+            detail::radix::sort(vec, 1);
+        }
+        else {
+            std::sort(vec.begin(), vec.end());
+        }
+    }
+
+    // Same as sort(vec), with the radix passes split over the policy's threads.
+    template <typename T, typename Allocator>
+    void sort(const parallel_policy& policy, vector<T, Allocator>& vec) {
+        if constexpr (detail::radix::sortable_v<T>) {
+            detail::radix::sort(vec, detail::radix::worker_count<T>(policy, vec.size()));
+        }
+        else {
+            std::sort(vec.begin(), vec.end());
+        }
+    }
+
+    // Stable sort of keys that applies the same permutation to values.
+    template <typename K, typename KeyAllocator, typename V, typename ValueAllocator>
+    void sort_by_key(const parallel_policy& policy, vector<K, KeyAllocator>& keys, vector<V, ValueAllocator>& values) {
+        if (keys.size() != values.size()) {
+            NP_VECTOR_THROW(std::invalid_argument("sort_by_key: keys and values differ in size"));
+        }
+
+        if constexpr (detail::radix::sortable_v<K>) {
+            detail::radix::sort_by_key(keys, values, detail::radix::worker_count<K>(policy, keys.size()));
+        }
+        else {
+            const std::size_t n = keys.size();
+            vector<std::size_t> order(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(), [&](const std::size_t a, const std::size_t b) { return keys[a] < keys[b]; });
+
+            vector<std::size_t> key_order(order);
+            detail::radix::apply_permutation(std::to_address(keys.data()), std::to_address(key_order.data()), n);
+            detail::radix::apply_permutation(std::to_address(values.data()), std::to_address(order.data()), n);
+        }
+    }
+
+    template <typename K, typename KeyAllocator, typename V, typename ValueAllocator>
+    void sort_by_key(vector<K, KeyAllocator>& keys, vector<V, ValueAllocator>& values) {
+        sort_by_key(parallel_policy{}.with_threads(1), keys, values);
+    }
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <istream>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+
+#include "exceptions.hpp"
+
+// Binary trace of np::vector operations, written by vectors built with NP_VECTOR_TRACE and read by
+// benchmarks/vector_replay. A trace is the 4-byte magic "NPVT", a version byte, then one record per
+// operation: the op byte, the vector id and the op's arguments, all integers LEB128-encoded.
+namespace np::trace {
+    enum class op : std::uint8_t {
+        push_back,
+        pop_back,
+        insert,        // position
+        erase,         // position, count
+        reserve,       // capacity
+        resize,        // size
+        clear,
+        shrink_to_fit,
+        destroy
+    };
+
+    struct event {
+        op type = op::push_back;
+        std::uint64_t vector_id = 0;
+        std::uint64_t first = 0;
+        std::uint64_t second = 0;
+    };
+
+    inline constexpr char magic[4] = {'N', 'P', 'V', 'T'};
+    inline constexpr std::uint8_t version = 1;
+
+    inline constexpr int argument_count(const op type) noexcept {
+        switch (type) {
+            case op::insert:
+            case op::reserve:
+            case op::resize:
+                return 1;
+            case op::erase:
+                return 2;
+            default:
+                return 0;
+        }
+    }
+
+    class writer {
+        std::ostream& out_;
+
+        void write_varint(std::uint64_t value) {
+            while (value >= 0x80) {
+                out_.put(static_cast<char>((value & 0x7f) | 0x80));
+                value >>= 7;
+            }
+            out_.put(static_cast<char>(value));
+        }
+
+    public:
+        explicit writer(std::ostream& out) : out_(out) {
+            out_.write(magic, sizeof(magic));
+            out_.put(static_cast<char>(version));
+        }
+
+        void write(const event& record) {
+            out_.put(static_cast<char>(record.type));
+            write_varint(record.vector_id);
+
+            const int arguments = argument_count(record.type);
+            if (arguments > 0) {
+                write_varint(record.first);
+            }
+            if (arguments > 1) {
+                write_varint(record.second);
+            }
+        }
+    };
+
+    class reader {
+        std::istream& in_;
+
+        std::uint64_t read_varint() {
+            std::uint64_t value = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7) {
+                const int byte = in_.get();
+                if (byte == std::istream::traits_type::eof()) {
+                    NP_VECTOR_THROW(std::runtime_error("Truncated trace record"));
+                }
+
+                value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0) {
+                    return value;
+                }
+            }
+
+            NP_VECTOR_THROW(std::runtime_error("Malformed trace varint"));
+        }
+
+    public:
+        explicit reader(std::istream& in) : in_(in) {
+            char header[sizeof(magic) + 1] = {};
+            in_.read(header, sizeof(header));
+            if (!in_ || !std::equal(magic, magic + sizeof(magic), header) || static_cast<std::uint8_t>(header[sizeof(magic)]) != version) {
+                NP_VECTOR_THROW(std::runtime_error("Not an np::vector trace"));
+            }
+        }
+
+        // Reads the next record; returns false at the end of the trace.
+        bool next(event& record) {
+            const int type = in_.get();
+            if (type == std::istream::traits_type::eof()) {
+                return false;
+            }
+            if (type > static_cast<int>(op::destroy)) {
+                NP_VECTOR_THROW(std::runtime_error("Unknown trace op"));
+            }
+
+            record = event{};
+            record.type = static_cast<op>(type);
+            record.vector_id = read_varint();
+
+            const int arguments = argument_count(record.type);
+            if (arguments > 0) {
+                record.first = read_varint();
+            }
+            if (arguments > 1) {
+                record.second = read_varint();
+            }
+
+            return true;
+        }
+    };
+
+    namespace detail {
+        struct recording_state {
+            std::atomic<bool> active{false};
+            std::mutex mutex;
+            std::optional<writer> output;
+        };
+
+        inline recording_state& state() {
+            static recording_state instance;
+            return instance;
+        }
+    }
+
+    inline std::uint64_t next_vector_id() noexcept {
+        static std::atomic<std::uint64_t> next{0};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Starts logging the operations of every traced vector in the process to out, which must
+    // outlive the recording.
+    inline void start_recording(std::ostream& out) {
+        detail::recording_state& state = detail::state();
+        std::lock_guard<std::mutex> lock(state.mutex);
+
+        state.output.emplace(out);
+        state.active.store(true, std::memory_order_release);
+    }
+
+    inline void stop_recording() {
+        detail::recording_state& state = detail::state();
+        std::lock_guard<std::mutex> lock(state.mutex);
+
+        state.active.store(false, std::memory_order_release);
+        state.output.reset();
+    }
+
+    inline void record(const op type, const std::uint64_t vector_id, const std::uint64_t first, const std::uint64_t second) {
+        detail::recording_state& state = detail::state();
+        if (!state.active.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.output) {
+            state.output->write(event{type, vector_id, first, second});
+        }
+    }
+}
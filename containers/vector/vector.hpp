@@ -1,14 +1,57 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
+#include <cstring>
+#include <expected>
 #include <initializer_list>
+#include <iterator>
 #include <iostream>
 #include <memory>
 #include <memory_resource>
+#include <new>
+#include <ranges>
+#include <span>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
+
+#include "aligned_allocator.hpp"
+#include "exceptions.hpp"
+#include "execution.hpp"
+#include "generator.hpp"
+#include "shrink.hpp"
+
+// Define NP_VECTOR_CHECKED_ITERATORS to make np::vector iterators carry their owner and validate
+// bounds and reallocation on every access. Release iterators are a single raw pointer.
+#if defined(NP_VECTOR_CHECKED_ITERATORS)
+#define NP_VECTOR_ITERATOR_CHECK(check) check
+#else
+#define NP_VECTOR_ITERATOR_CHECK(check)
+#endif
+
+// Define NP_VECTOR_TRACE to let np::trace::start_recording() log every np::vector operation to a
+// binary trace for benchmarks/vector_replay. Without it the hooks compile to nothing.
+#if defined(NP_VECTOR_TRACE)
+#include "trace.hpp"
+#define NP_VECTOR_TRACE_EVENT_FOR(object, type, first, second) \
+    ::np::trace::record(::np::trace::op::type, (object).trace_id_, static_cast<std::uint64_t>(first), static_cast<std::uint64_t>(second))
+#else
+#define NP_VECTOR_TRACE_EVENT_FOR(object, type, first, second)
+#endif
+#define NP_VECTOR_TRACE_EVENT(type, first, second) NP_VECTOR_TRACE_EVENT_FOR(*this, type, first, second)
 
 namespace np {
+    template <typename T, typename Allocator>
+    class frozen_vector;
+
+    // Failure reported by np::vector's try_* members. Value-initialized (zero) means success.
+    enum class vector_error {
+        out_of_memory = 1,
+        length_exceeded,
+        out_of_range
+    };
+
     template <typename T, typename Allocator = std::allocator<T>>
     class vector {
     public:
@@ -22,7 +65,7 @@ namespace np {
         using reference = value_type&;
         using const_reference = const value_type&;
         using pointer = typename std::allocator_traits<allocator_type>::pointer;
-        using const_pointer = const pointer;
+        using const_pointer = typename std::allocator_traits<allocator_type>::const_pointer;
         using size_type = std::size_t;
         using difference_type = std::ptrdiff_t;
 
@@ -35,64 +78,108 @@ namespace np {
 
         allocator_type allocator_;
 
+        // Shrink policy and trim registry membership; only allocated once either is set up.
+        struct shrink_state : detail::trim_node {
+            vector* owner = nullptr;
+            shrink_policy policy;
+            bool automatic = false;
+        };
+
+        std::unique_ptr<shrink_state> shrink_;
+
+#if defined(NP_VECTOR_TRACE)
+        std::uint64_t trace_id_ = trace::next_vector_id();
+#endif
+
+#if defined(NP_VECTOR_CHECKED_ITERATORS)
+        // Bumped on every reallocation so checked iterators can detect that they were invalidated.
+        size_type generation_ = 0;
+#endif
+
+        void invalidate_iterators() noexcept {
+            NP_VECTOR_ITERATOR_CHECK(++generation_);
+        }
+
         template <bool is_const>
         class base_iterator {
         public:
-            using pointer_type = std::conditional_t<is_const, const_pointer, pointer>;
-            using reference_type = std::conditional_t<is_const, const_reference, reference>;
+            using iterator_concept = std::contiguous_iterator_tag;
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = T;
+            using element_type = std::conditional_t<is_const, const T, T>;
             using difference_type = std::ptrdiff_t;
+            using pointer = element_type*;
+            using reference = element_type&;
 
-            pointer_type ptr_ = nullptr;
-            pointer_type begin_ = nullptr;
-            pointer_type end_ = nullptr;
+            pointer ptr_ = nullptr;
+
+#if defined(NP_VECTOR_CHECKED_ITERATORS)
+            const vector* owner_ = nullptr;
+            size_type generation_ = 0;
+#endif
 
             /***************************/
             base_iterator() noexcept = default;
 
-            explicit base_iterator(pointer_type ptr, pointer_type begin = nullptr, pointer_type end = nullptr) noexcept : ptr_(ptr), begin_(begin), end_(end) {}
+#if defined(NP_VECTOR_CHECKED_ITERATORS)
+            base_iterator(pointer ptr, const vector* owner, size_type generation) noexcept : ptr_(ptr), owner_(owner), generation_(generation) {}
+#else
+            explicit base_iterator(pointer ptr) noexcept : ptr_(ptr) {}
+#endif
 
-            base_iterator(const base_iterator& other) noexcept : ptr_(other.ptr_), begin_(other.begin_), end_(other.end_) {}
+            base_iterator(const base_iterator& other) noexcept = default;
 
-            base_iterator(base_iterator&& other) noexcept = default; // *
+            base_iterator(base_iterator&& other) noexcept = default;
 
             base_iterator& operator=(const base_iterator& other) noexcept = default;
 
-            base_iterator& operator=(base_iterator&& other) noexcept = default; // *
+            base_iterator& operator=(base_iterator&& other) noexcept = default;
             /***************************/
 
 
             /***************************/
-            reference_type operator*() const {
+            reference operator*() const {
+                NP_VECTOR_ITERATOR_CHECK(check_dereferenceable(0));
                 return *ptr_;
             }
 
-            pointer_type operator->() const {
+            // Only checks that the iterator is valid and within [begin, end]: std::to_address() goes
+            // through operator-> and must work on end() for a contiguous iterator.
+            pointer operator->() const {
+                NP_VECTOR_ITERATOR_CHECK(check_offset(0));
                 return ptr_;
             }
+
+            reference operator[](difference_type value) const {
+                NP_VECTOR_ITERATOR_CHECK(check_dereferenceable(value));
+                return ptr_[value];
+            }
             /***************************/
 
 
 
             /***************************/
             base_iterator& operator++() {
+                NP_VECTOR_ITERATOR_CHECK(check_offset(1));
                 ++ptr_;
                 return *this;
             }
 
             base_iterator& operator--() {
+                NP_VECTOR_ITERATOR_CHECK(check_offset(-1));
                 --ptr_;
                 return *this;
             }
 
             base_iterator operator++(int) {
                 base_iterator temp = *this;
-                ++ptr_;
+                ++*this;
                 return temp;
             }
 
             base_iterator operator--(int) {
                 base_iterator temp = *this;
-                --ptr_;
+                --*this;
                 return temp;
             }
             /***************************/
@@ -101,23 +188,32 @@ namespace np {
 
             /***************************/
             base_iterator operator+(difference_type value) const {
-                return base_iterator(ptr_ + value, begin_, end_);
+                base_iterator temp = *this;
+                return temp += value;
+            }
+
+            friend base_iterator operator+(difference_type value, const base_iterator& it) {
+                return it + value;
             }
 
             base_iterator operator-(difference_type value) const {
-                return base_iterator(ptr_ - value, begin_, end_);
+                base_iterator temp = *this;
+                return temp -= value;
             }
 
-            difference_type operator-(const base_iterator& other) const {
-                return ptr_ - other.ptr_;
+            friend difference_type operator-(const base_iterator& lhs, const base_iterator& rhs) {
+                NP_VECTOR_ITERATOR_CHECK(lhs.check_compatible(rhs));
+                return lhs.ptr_ - rhs.ptr_;
             }
 
             base_iterator& operator+=(difference_type value) {
+                NP_VECTOR_ITERATOR_CHECK(check_offset(value));
                 ptr_ += value;
                 return *this;
             }
 
             base_iterator& operator-=(difference_type value) {
+                NP_VECTOR_ITERATOR_CHECK(check_offset(-value));
                 ptr_ -= value;
                 return *this;
             }
@@ -126,43 +222,257 @@ namespace np {
 
 
             /***************************/
-            bool operator==(const base_iterator& other) const {
-                return ptr_ == other.ptr_;
+            // Hidden friends, so a mixed iterator / const_iterator pair resolves to the const_iterator
+            // overloads through the implicit conversion, as with std::vector.
+            friend bool operator==(const base_iterator& lhs, const base_iterator& rhs) {
+                NP_VECTOR_ITERATOR_CHECK(lhs.check_compatible(rhs));
+                return lhs.ptr_ == rhs.ptr_;
             }
 
-            bool operator!=(const base_iterator& other) const {
-                return ptr_ != other.ptr_;
+            friend bool operator!=(const base_iterator& lhs, const base_iterator& rhs) {
+                return !(lhs == rhs);
             }
 
-            bool operator<(const base_iterator& other) const {
-                return ptr_ < other.ptr_;
+            friend bool operator<(const base_iterator& lhs, const base_iterator& rhs) {
+                NP_VECTOR_ITERATOR_CHECK(lhs.check_compatible(rhs));
+                return lhs.ptr_ < rhs.ptr_;
             }
 
-            bool operator<=(const base_iterator& other) const {
-                return ptr_ <= other.ptr_;
+            friend bool operator<=(const base_iterator& lhs, const base_iterator& rhs) {
+                return !(rhs < lhs);
             }
 
-            bool operator>(const base_iterator& other) const {
-                return ptr_ > other.ptr_;
+            friend bool operator>(const base_iterator& lhs, const base_iterator& rhs) {
+                return rhs < lhs;
             }
 
-            bool operator>=(const base_iterator& other) const {
-                return ptr_ >= other.ptr_;
+            friend bool operator>=(const base_iterator& lhs, const base_iterator& rhs) {
+                return !(lhs < rhs);
             }
             /***************************/
 
 
 
             /***************************/
-            explicit operator base_iterator<true>() const {
-                return base_iterator<true>(ptr_, begin_, end_);
+            operator base_iterator<true>() const noexcept {
+#if defined(NP_VECTOR_CHECKED_ITERATORS)
+                return base_iterator<true>(ptr_, owner_, generation_);
+#else
+                return base_iterator<true>(ptr_);
+#endif
             }
 
-            explicit operator base_iterator<false>() const {
-                return base_iterator<false>(ptr_, begin_, end_);
+            explicit operator base_iterator<false>() const noexcept {
+#if defined(NP_VECTOR_CHECKED_ITERATORS)
+                return base_iterator<false>(const_cast<T*>(ptr_), owner_, generation_);
+#else
+                return base_iterator<false>(const_cast<T*>(ptr_));
+#endif
             }
             /***************************/
+
+#if defined(NP_VECTOR_CHECKED_ITERATORS)
+        private:
+            void check_valid() const {
+                if (owner_ == nullptr || generation_ != owner_->generation_) {
+                    NP_VECTOR_THROW(std::logic_error("Iterator invalidated"));
+                }
+            }
+
+            void check_dereferenceable(difference_type value) const {
+                check_valid();
+
+                const difference_type index = ptr_ - std::to_address(owner_->data_) + value;
+                if (index < 0 || index >= static_cast<difference_type>(owner_->size_)) {
+                    NP_VECTOR_THROW(std::out_of_range("Iterator out of range"));
+                }
+            }
+
+            void check_offset(difference_type value) const {
+                check_valid();
+
+                const difference_type index = ptr_ - std::to_address(owner_->data_) + value;
+                if (index < 0 || index > static_cast<difference_type>(owner_->size_)) {
+                    NP_VECTOR_THROW(std::out_of_range("Iterator out of range"));
+                }
+            }
+
+            void check_compatible(const base_iterator& other) const {
+                if (owner_ != other.owner_) {
+                    NP_VECTOR_THROW(std::logic_error("Iterators belong to different vectors"));
+                }
+            }
+#endif
         };
+
+        template <bool is_const>
+        base_iterator<is_const> make_iterator(typename base_iterator<is_const>::pointer ptr) const noexcept {
+#if defined(NP_VECTOR_CHECKED_ITERATORS)
+            return base_iterator<is_const>(ptr, this, generation_);
+#else
+            return base_iterator<is_const>(ptr);
+#endif
+        }
+
+        // Copy-constructs n elements into uninitialized storage. On failure the constructed prefix is destroyed.
+        void copy_construct_n(const_pointer src, const size_type n, pointer dst) {
+            if constexpr (std::is_trivially_copyable_v<value_type>) {
+                if (n != 0) {
+                    std::memcpy(std::to_address(dst), std::to_address(src), n * sizeof(value_type));
+                }
+            }
+            else {
+                size_type index = 0;
+                NP_VECTOR_TRY {
+                    for (; index < n; ++index) {
+                        allocator_traits::construct(allocator_, dst + index, src[index]);
+                    }
+                } NP_VECTOR_CATCH(...) {
+                    for (size_type i = 0; i < index; ++i) {
+                        allocator_traits::destroy(allocator_, dst + i);
+                    }
+                    NP_VECTOR_RETHROW;
+                }
+            }
+        }
+
+        // Destroys all elements and returns the buffer to the allocator, leaving the vector empty.
+        void deallocate_storage() noexcept {
+            if (data_ != nullptr) {
+                for (size_type i = 0; i < size_; ++i) {
+                    allocator_traits::destroy(allocator_, data_ + i);
+                }
+
+                allocator_traits::deallocate(allocator_, data_, capacity_);
+            }
+
+            data_ = nullptr;
+            size_ = 0;
+            capacity_ = 0;
+            invalidate_iterators();
+        }
+
+        // Allocates exactly n elements for an empty vector and constructs them in parallel.
+        template <typename... Args>
+        void parallel_initialize(const parallel_policy& policy, const size_type n, const Args&... args) {
+            if (n == 0) {
+                return;
+            }
+
+            data_ = allocator_traits::allocate(allocator_, n);
+            capacity_ = n;
+            NP_VECTOR_TRY {
+                parallel_construct(policy, 0, n, args...);
+            } NP_VECTOR_CATCH(...) {
+                allocator_traits::deallocate(allocator_, data_, n);
+                data_ = nullptr;
+                capacity_ = 0;
+                NP_VECTOR_RETHROW;
+            }
+
+            size_ = n;
+        }
+
+        // Constructs count elements from args at data_ + offset on the policy's threads, so each page
+        // is first touched by the worker that owns it. Elements are value-initialized when args is
+        // empty; unlike default-initialization that writes every page. All or nothing on failure.
+        template <typename... Args>
+        void parallel_construct(const parallel_policy& policy, const size_type offset, const size_type count, const Args&... args) {
+            pointer base = data_ + offset;
+
+            auto destroy = [&](const size_type begin, const size_type end) {
+                for (size_type i = begin; i < end; ++i) {
+                    allocator_traits::destroy(allocator_, base + i);
+                }
+            };
+
+            detail::parallel::construct_ranges(detail::parallel::make_partition<value_type>(policy, count, std::to_address(base)),
+                [&](const size_type begin, const size_type end) {
+                    size_type index = begin;
+                    NP_VECTOR_TRY {
+                        for (; index < end; ++index) {
+                            allocator_traits::construct(allocator_, base + index, args...);
+                        }
+                    } NP_VECTOR_CATCH(...) {
+                        destroy(begin, index);
+                        NP_VECTOR_RETHROW;
+                    }
+                },
+                destroy);
+        }
+
+        // Takes over other's shrink policy and registry membership, dropping this vector's own.
+        void adopt_shrink_state(vector& other) noexcept {
+            shrink_ = std::move(other.shrink_);
+            if (shrink_ != nullptr) {
+                shrink_->owner = this;
+            }
+        }
+
+        shrink_state& shrink_control() {
+            if (shrink_ == nullptr) {
+                shrink_ = std::make_unique<shrink_state>();
+                shrink_->owner = this;
+                shrink_->trim = &trim_node_to_size;
+            }
+            return *shrink_;
+        }
+
+        static std::size_t trim_node_to_size(detail::trim_node& node) {
+            vector& owner = *static_cast<shrink_state&>(node).owner;
+            const size_type before = owner.capacity_;
+            if (owner.size_ < owner.capacity_) {
+                owner.shrink_capacity(owner.size_);
+            }
+            return (before - owner.capacity_) * sizeof(value_type);
+        }
+
+        // Moves the elements into an exactly sized buffer, or frees the buffer when new_capacity is 0.
+        void shrink_capacity(const size_type new_capacity) {
+            if (new_capacity == 0) {
+                deallocate_storage();
+            }
+            else {
+                reallocate(new_capacity);
+            }
+        }
+
+        // Trims to size if the registry asked for it since the last check; true if it did.
+        bool trim_on_request() {
+            trim_registry* registry = shrink_->registry;
+            if (registry == nullptr) {
+                return false;
+            }
+
+            const std::uint64_t epoch = registry->epoch();
+            if (epoch == shrink_->seen_epoch) {
+                return false;
+            }
+
+            shrink_->seen_epoch = epoch;
+            if (size_ < capacity_) {
+                shrink_capacity(size_);
+            }
+            return true;
+        }
+
+        // Honours a pending trim request, then applies the shrink policy after elements were removed.
+        void maybe_shrink() {
+            if (shrink_ == nullptr || trim_on_request() || !shrink_->automatic) {
+                return;
+            }
+
+            const shrink_policy& policy = shrink_->policy;
+            if (capacity_ * sizeof(value_type) <= policy.min_capacity_bytes || size_ >= capacity_ / policy.shrink_below) {
+                return;
+            }
+
+            const size_type floor = policy.min_capacity_bytes / sizeof(value_type);
+            const size_type target = size_ == 0 ? 0 : std::max(size_ * policy.keep_factor, floor);
+            if (target < capacity_) {
+                shrink_capacity(target);
+            }
+        }
     public:
         using iterator = base_iterator<false>;
         using const_iterator = base_iterator<true>;
@@ -173,87 +483,252 @@ namespace np {
     public:
         vector() = default;
 
+        explicit vector(const allocator_type& allocator) noexcept : allocator_(allocator) {}
+
         explicit vector(const size_type n) : capacity_(n), size_(n), data_(allocator_traits::allocate(allocator_, n)) {
             std::uninitialized_default_construct_n(data_, n);
+            NP_VECTOR_TRACE_EVENT(resize, n, 0);
         }
 
         vector(const size_type n, const_reference value) : capacity_(n), size_(n), data_(allocator_traits::allocate(allocator_, n)) {
             std::uninitialized_fill_n(data_, n, value);
+            NP_VECTOR_TRACE_EVENT(resize, n, 0);
+        }
+
+        // Parallel counterparts of vector(n) and vector(n, value); see np::parallel_policy for the page layout.
+        vector(const parallel_policy& policy, const size_type n) {
+            parallel_initialize(policy, n);
+            NP_VECTOR_TRACE_EVENT(resize, n, 0);
+        }
+
+        vector(const parallel_policy& policy, const size_type n, const_reference value) {
+            parallel_initialize(policy, n, value);
+            NP_VECTOR_TRACE_EVENT(resize, n, 0);
         }
 
         vector(const std::initializer_list<T>& list) : capacity_(list.size()), size_(list.size()), data_(allocator_traits::allocate(allocator_, capacity_)) {
             std::uninitialized_copy(list.begin(), list.end(), data_);
+            NP_VECTOR_TRACE_EVENT(resize, size_, 0);
         }
 
-        template <class InputIt>
+        template <std::input_iterator InputIt>
         vector(InputIt first, InputIt last) {
             if (first == last) {
                 return;
             }
 
             size_type distance = std::distance(first, last);
-            reserve(distance);
+            reallocate(distance);
 
             for (; first != last; ++first) {
-                push_back(*first);
+                allocator_traits::construct(allocator_, data_ + size_, *first);
+                ++size_;
             }
+            NP_VECTOR_TRACE_EVENT(resize, size_, 0);
         }
 
-        vector (const vector& other) {
-            Allocator new_allocator = allocator_traits::select_on_container_copy_construction()
-                ? other.allocator_
-                : allocator_;
+        vector(const vector& other) : allocator_(allocator_traits::select_on_container_copy_construction(other.allocator_)) {
+            if (other.size_ == 0) {
+                return;
+            }
+
+            pointer new_arr = allocator_traits::allocate(allocator_, other.size_);
+            NP_VECTOR_TRY {
+                copy_construct_n(other.data_, other.size_, new_arr);
+            } NP_VECTOR_CATCH(...) {
+                allocator_traits::deallocate(allocator_, new_arr, other.size_);
+                NP_VECTOR_RETHROW;
+            }
+
+            data_ = new_arr;
+            size_ = other.size_;
+            capacity_ = other.size_;
+            NP_VECTOR_TRACE_EVENT(resize, size_, 0);
+        }
 
-            pointer new_arr = allocator_traits::allocate(new_allocator, other.capacity_);
+        vector& operator=(const vector& other) {
+            if (this == &other) {
+                return *this;
+            }
 
-            size_type index = 0;
-            try {
-                for (; index < other.size_; ++index) {
-                    allocator_traits::construct(new_allocator, new_arr + index, other[index]);
+            if constexpr (allocator_traits::propagate_on_container_copy_assignment::value) {
+                if (allocator_ != other.allocator_) {
+                    // Storage owned by the old allocator can't outlive it, so drop it before switching.
+                    deallocate_storage();
                 }
-            } catch (...) {
-                for (size_type i = 0; i < index; ++i) {
-                    allocator_traits::destroy(new_allocator, new_arr + i);
+                allocator_ = other.allocator_;
+            }
+
+            if (other.size_ > capacity_) {
+                pointer new_arr = allocator_traits::allocate(allocator_, other.size_);
+                NP_VECTOR_TRY {
+                    copy_construct_n(other.data_, other.size_, new_arr);
+                } NP_VECTOR_CATCH(...) {
+                    allocator_traits::deallocate(allocator_, new_arr, other.size_);
+                    NP_VECTOR_RETHROW;
                 }
 
-                allocator_traits::deallocate(new_allocator, new_arr, other.capacity_);
-                throw;
-            }
+                deallocate_storage();
 
-            if (data_ != nullptr) {
-                for (size_type i = 0; i < other.size_; ++i) {
-                    allocator_traits::destroy(allocator_, data_ + i);
+                data_ = new_arr;
+                capacity_ = other.size_;
+                invalidate_iterators();
+            }
+            else if constexpr (std::is_trivially_copyable_v<value_type>) {
+                if (other.size_ != 0) {
+                    std::memcpy(std::to_address(data_), std::to_address(other.data_), other.size_ * sizeof(value_type));
                 }
+            }
+            else {
+                const size_type common = std::min(size_, other.size_);
+                std::copy(other.data_, other.data_ + common, data_);
 
-                allocator_traits::deallocate(allocator_, data_, capacity_);
+                if (other.size_ > size_) {
+                    copy_construct_n(other.data_ + size_, other.size_ - size_, data_ + size_);
+                }
+                else {
+                    for (size_type i = other.size_; i < size_; ++i) {
+                        allocator_traits::destroy(allocator_, data_ + i);
+                    }
+                }
             }
 
-            data_ = new_arr;
             size_ = other.size_;
-            capacity_ = other.capacity_;
-            allocator_ = new_allocator;
+            NP_VECTOR_TRACE_EVENT(resize, size_, 0);
+
+            return *this;
         }
 
-        vector& operator=(const vector& other) {
-            Allocator new_allocator = allocator_traits::propagate_on_container_copy_assignment::value
-                ? other.allocator_
-                : allocator_;
+        vector(vector&& other) noexcept
+            : capacity_(std::exchange(other.capacity_, 0)),
+              size_(std::exchange(other.size_, 0)),
+              data_(std::exchange(other.data_, nullptr)),
+              allocator_(std::move(other.allocator_)),
+              shrink_(std::move(other.shrink_)) {
+            if (shrink_ != nullptr) {
+                shrink_->owner = this;
+            }
+            other.invalidate_iterators();
+            NP_VECTOR_TRACE_EVENT(resize, size_, 0);
+            NP_VECTOR_TRACE_EVENT_FOR(other, clear, 0, 0);
+        }
 
-            pointer new_arr = allocator_traits::allocate(new_allocator, other.capacity_);
+        vector& operator=(vector&& other) noexcept(allocator_traits::propagate_on_container_move_assignment::value || allocator_traits::is_always_equal::value) {
+            if (this == &other) {
+                return *this;
+            }
 
-            size_type index = 0;
-            try {
-                for (; index < other.size_; ++index) {
-                    allocator_traits::construct(new_allocator, new_arr + index, other[index]);
+            if constexpr (!allocator_traits::propagate_on_container_move_assignment::value && !allocator_traits::is_always_equal::value) {
+                if (allocator_ != other.allocator_) {
+                    // The buffer can't change hands between unequal allocators, so fall back to copying.
+                    *this = static_cast<const vector&>(other);
+                    other.deallocate_storage();
+                    adopt_shrink_state(other);
+                    NP_VECTOR_TRACE_EVENT_FOR(other, clear, 0, 0);
+                    return *this;
                 }
-            } catch (...) {
-                for (size_type i = 0; i < index; ++i) {
-                    allocator_traits::destroy(new_allocator, new_arr + i);
+            }
+
+            deallocate_storage();
+            if constexpr (allocator_traits::propagate_on_container_move_assignment::value) {
+                allocator_ = std::move(other.allocator_);
+            }
+
+            capacity_ = std::exchange(other.capacity_, 0);
+            size_ = std::exchange(other.size_, 0);
+            data_ = std::exchange(other.data_, nullptr);
+            adopt_shrink_state(other);
+            other.invalidate_iterators();
+            NP_VECTOR_TRACE_EVENT(resize, size_, 0);
+            NP_VECTOR_TRACE_EVENT_FOR(other, clear, 0, 0);
+
+            return *this;
+        }
+
+        // Hands the buffer over to an immutable, reference-counted snapshot without copying any element.
+        // Requires containers/vector/frozen_vector.hpp.
+        frozen_vector<T, Allocator> freeze() && {
+            // A frozen buffer must never be trimmed under its readers.
+            shrink_.reset();
+            return frozen_vector<T, Allocator>(std::move(*this));
+        }
+
+        void reserve(const size_type new_capacity) {
+            NP_VECTOR_TRACE_EVENT(reserve, new_capacity, 0);
+
+            if (new_capacity > capacity_) {
+                reallocate(new_capacity);
+            }
+        }
+
+        // Non-throwing reserve(): fails with out_of_memory when the allocator can't provide the buffer
+        // and with length_exceeded past max_size(). Element constructors may still throw.
+        [[nodiscard]] std::expected<void, vector_error> try_reserve(const size_type new_capacity) {
+            if (new_capacity > capacity_) {
+                if (const vector_error error = try_reallocate(new_capacity); error != vector_error{}) {
+                    return std::unexpected(error);
                 }
-                allocator_traits::deallocate(new_allocator, new_arr, other.capacity_);
-                throw;
             }
 
+            NP_VECTOR_TRACE_EVENT(reserve, new_capacity, 0);
+            return {};
+        }
+
+    private:
+        size_type next_capacity() const noexcept {
+            return capacity_ ? capacity_ * 2 : 1;
+        }
+
+        // Allocates n elements, or returns nullptr when the allocator is out of memory. Allocators may
+        // provide a noexcept try_allocate(n); std::allocator is asked through nothrow operator new.
+        pointer try_allocate(const size_type n) noexcept {
+            if constexpr (requires { { allocator_.try_allocate(n) } -> std::convertible_to<pointer>; }) {
+                return allocator_.try_allocate(n);
+            }
+            else if constexpr (std::is_same_v<allocator_type, std::allocator<value_type>>) {
+                if constexpr (alignof(value_type) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                    return static_cast<pointer>(::operator new(n * sizeof(value_type), std::align_val_t{alignof(value_type)}, std::nothrow));
+                }
+                else {
+                    return static_cast<pointer>(::operator new(n * sizeof(value_type), std::nothrow));
+                }
+            }
+            else {
+                NP_VECTOR_TRY {
+                    return allocator_traits::allocate(allocator_, n);
+                }
+                NP_VECTOR_CATCH(const std::bad_alloc&) {
+                    return nullptr;
+                }
+            }
+        }
+
+        // Moves (or, if moving may throw, copies) the elements into new_arr. On failure the ones
+        // already built there are destroyed again; new_arr itself is left to the caller.
+        void relocate_into(pointer new_arr) {
+            if constexpr (std::is_trivially_copyable_v<value_type>) {
+                if (size_ != 0) {
+                    std::memcpy(std::to_address(new_arr), std::to_address(data_), size_ * sizeof(value_type));
+                }
+            }
+            else {
+                size_type index = 0;
+                NP_VECTOR_TRY {
+                    for (; index < size_; ++index) {
+                        allocator_traits::construct(allocator_, new_arr + index, std::move_if_noexcept(data_[index]));
+                    }
+                }
+                NP_VECTOR_CATCH(...) {
+                    for (size_type i = 0; i < index; ++i) {
+                        allocator_traits::destroy(allocator_, new_arr + i);
+                    }
+                    NP_VECTOR_RETHROW;
+                }
+            }
+        }
+
+        // Releases the old buffer and switches to new_arr, which already holds the elements.
+        void adopt(pointer new_arr, const size_type new_capacity) noexcept {
             if (data_ != nullptr) {
                 for (size_type i = 0; i < size_; ++i) {
                     allocator_traits::destroy(allocator_, data_ + i);
@@ -263,181 +738,442 @@ namespace np {
             }
 
             data_ = new_arr;
-            size_ = other.size_;
-            capacity_ = other.capacity_;
+            capacity_ = new_capacity;
+            invalidate_iterators();
+        }
 
-            return *this;
+        void move_to(pointer new_arr, const size_type new_capacity) {
+            NP_VECTOR_TRY {
+                relocate_into(new_arr);
+            }
+            NP_VECTOR_CATCH(...) {
+                allocator_traits::deallocate(allocator_, new_arr, new_capacity);
+                NP_VECTOR_RETHROW;
+            }
+
+            adopt(new_arr, new_capacity);
         }
 
-        void reserve(const size_type new_capacity) {
-            if (new_capacity <= capacity_) {
-                return;
+        // Moves the elements into a new buffer of new_capacity. Growth paths call this rather than
+        // reserve() so that traces only contain the reserve calls the user made.
+        void reallocate(const size_type new_capacity) {
+            if (new_capacity > max_size()) {
+                NP_VECTOR_THROW(std::length_error("Vector capacity exceeds max_size()"));
             }
 
-            pointer new_arr = allocator_traits::allocate(allocator_, new_capacity);
+            move_to(allocator_traits::allocate(allocator_, new_capacity), new_capacity);
+        }
 
-            size_type index = 0;
-            try {
-                for (; index < size_; ++index) {
-                    allocator_traits::construct(allocator_, new_arr + index, data_[index]);
-                }
+        vector_error try_reallocate(const size_type new_capacity) {
+            if (new_capacity > max_size()) {
+                return vector_error::length_exceeded;
+            }
+
+            const pointer new_arr = try_allocate(new_capacity);
+            if (new_arr == nullptr) {
+                return vector_error::out_of_memory;
             }
-            catch (...) {
-                for (size_type i = 0; i < index; ++i) {
-                    allocator_traits::destroy(allocator_, new_arr + i);
-                }
 
-                allocator_traits::deallocate(allocator_, new_arr, capacity_);
-                throw;
+            move_to(new_arr, new_capacity);
+            return {};
+        }
+
+        // Slow path of emplace_back on a full buffer, kept out of line so the fast path stays a
+        // compare, a construct and an increment. The new element is built before the old ones move,
+        // so args may refer to an element of this vector.
+        template <typename... Args>
+        [[gnu::noinline]] void emplace_into(const pointer new_arr, const size_type new_capacity, Args&&... args) {
+            NP_VECTOR_TRY {
+                allocator_traits::construct(allocator_, new_arr + size_, std::forward<Args>(args)...);
+            }
+            NP_VECTOR_CATCH(...) {
+                allocator_traits::deallocate(allocator_, new_arr, new_capacity);
+                NP_VECTOR_RETHROW;
             }
 
-            for (size_type i = 0; i < size_; ++i) {
-                allocator_traits::destroy(allocator_, data_ + i);
+            NP_VECTOR_TRY {
+                relocate_into(new_arr);
+            }
+            NP_VECTOR_CATCH(...) {
+                allocator_traits::destroy(allocator_, new_arr + size_);
+                allocator_traits::deallocate(allocator_, new_arr, new_capacity);
+                NP_VECTOR_RETHROW;
             }
 
-            allocator_traits::deallocate(allocator_, data_, new_capacity);
+            adopt(new_arr, new_capacity);
+            ++size_;
+        }
 
-            data_ = new_arr;
-            capacity_ = new_capacity;
+        template <typename... Args>
+        [[gnu::noinline]] void grow_and_emplace(Args&&... args) {
+            const size_type new_capacity = next_capacity();
+            if (new_capacity > max_size()) {
+                NP_VECTOR_THROW(std::length_error("Vector capacity exceeds max_size()"));
+            }
+
+            emplace_into(allocator_traits::allocate(allocator_, new_capacity), new_capacity, std::forward<Args>(args)...);
+        }
+
+        // Hands inserter a copy of value when value is one of this vector's elements, which shifting
+        // or reallocating would otherwise disturb.
+        template <typename Inserter>
+        iterator insert_at(const size_type index, const_reference value, Inserter&& inserter) {
+            const value_type* address = std::addressof(value);
+            if (address >= std::to_address(data_) && address < std::to_address(data_) + size_) {
+                const value_type copy(value);
+                return inserter(index, copy);
+            }
+            return inserter(index, value);
         }
 
+        // Inserts value at index into a buffer with room for it.
+        iterator insert_unchecked(const size_type index, const_reference value) {
+            pointer ptr = data_ + index;
+
+            if (index < size_) {
+                allocator_traits::construct(allocator_, data_ + size_, std::move(data_[size_ - 1]));
+                std::move_backward(ptr, data_ + size_ - 1, data_ + size_);
+                *ptr = value;
+            }
+            else {
+                allocator_traits::construct(allocator_, ptr, value);
+            }
+            ++size_;
+
+            NP_VECTOR_TRACE_EVENT(insert, index, 0);
+
+            return make_iterator<false>(data_ + index);
+        }
+
+    public:
         void push_back(const_reference element) {
-            if (size_ == capacity_) {
-                reserve(capacity_ ? capacity_ * 2 : 1);
+            NP_VECTOR_TRACE_EVENT(push_back, 0, 0);
+
+            if (size_ == capacity_) [[unlikely]] {
+                grow_and_emplace(element);
+                return;
             }
 
-            typename std::allocator_traits<Allocator>::pointer ptr = allocator_traits::allocate(allocator_, 1);
-            try {
-                std::allocator_traits<Allocator>::construct(allocator_, ptr, element);
+            allocator_traits::construct(allocator_, data_ + size_, element);
+            ++size_;
+        }
 
-                data_[size_++] = *ptr;
+        void push_back(value_type&& element) {
+            emplace_back(std::move(element));
+        }
+
+        template <typename... Args>
+        reference emplace_back(Args&&... args) {
+            NP_VECTOR_TRACE_EVENT(push_back, 0, 0);
+
+            if (size_ == capacity_) [[unlikely]] {
+                grow_and_emplace(std::forward<Args>(args)...);
             }
-            catch (...) {
-                allocator_traits::deallocate(allocator_, ptr, 1);
-                throw;
+            else {
+                allocator_traits::construct(allocator_, data_ + size_, std::forward<Args>(args)...);
+                ++size_;
             }
+
+            return data_[size_ - 1];
         }
 
+        // Non-throwing push_back(): on out_of_memory or length_exceeded the vector is unchanged.
+        [[nodiscard]] std::expected<void, vector_error> try_push_back(const_reference element) {
+            if (auto result = try_emplace_back(element); !result) {
+                return std::unexpected(result.error());
+            }
+            return {};
+        }
+
+        [[nodiscard]] std::expected<void, vector_error> try_push_back(value_type&& element) {
+            if (auto result = try_emplace_back(std::move(element)); !result) {
+                return std::unexpected(result.error());
+            }
+            return {};
+        }
+
+        template <typename... Args>
+        [[nodiscard]] std::expected<iterator, vector_error> try_emplace_back(Args&&... args) {
+            if (size_ == capacity_) [[unlikely]] {
+                const size_type new_capacity = next_capacity();
+                if (new_capacity > max_size()) {
+                    return std::unexpected(vector_error::length_exceeded);
+                }
+
+                const pointer new_arr = try_allocate(new_capacity);
+                if (new_arr == nullptr) {
+                    return std::unexpected(vector_error::out_of_memory);
+                }
+                emplace_into(new_arr, new_capacity, std::forward<Args>(args)...);
+            }
+            else {
+                allocator_traits::construct(allocator_, data_ + size_, std::forward<Args>(args)...);
+                ++size_;
+            }
+
+            NP_VECTOR_TRACE_EVENT(push_back, 0, 0);
+            return make_iterator<false>(data_ + size_ - 1);
+        }
+
+        // Appends everything source yields, e.g. an np::generator reading records off a socket. Sized
+        // ranges reserve once; otherwise the buffer grows by at least batch elements at a time and
+        // each free stretch is filled without per-element capacity checks. Returns the number of
+        // elements appended; if source throws, the elements appended so far are kept.
+        template <std::ranges::input_range Range>
+            requires std::constructible_from<value_type, std::ranges::range_reference_t<Range>>
+        size_type append_from(Range&& source, const size_type batch = 256) {
+            const size_type old_size = size_;
+
+            if constexpr (std::ranges::sized_range<Range>) {
+                const size_type needed = size_ + static_cast<size_type>(std::ranges::size(source));
+                if (needed > capacity_) {
+                    reallocate(needed);
+                }
+            }
+
+            auto it = std::ranges::begin(source);
+            const auto last = std::ranges::end(source);
+            while (it != last) {
+                if (size_ == capacity_) {
+                    reallocate(std::max(capacity_ * 2, size_ + std::max<size_type>(batch, 1)));
+                }
+
+                for (const pointer limit = data_ + capacity_; data_ + size_ != limit && it != last; ++it) {
+                    allocator_traits::construct(allocator_, data_ + size_, *it);
+                    ++size_;
+                }
+            }
+
+            NP_VECTOR_TRACE_EVENT(resize, size_, 0);
+            return size_ - old_size;
+        }
+
+        // Yields the elements as consecutive spans of at most n elements. Positions are re-read on
+        // every step, so elements may be appended between batches; anything else that reallocates
+        // invalidates the last span handed out.
+        generator<std::span<value_type>> chunks(const size_type n) {
+            if (n == 0) {
+                NP_VECTOR_THROW(std::invalid_argument("Chunk size must be positive"));
+            }
+            return chunks_of<value_type>(this, n);
+        }
+
+        generator<std::span<const value_type>> chunks(const size_type n) const {
+            if (n == 0) {
+                NP_VECTOR_THROW(std::invalid_argument("Chunk size must be positive"));
+            }
+            return chunks_of<const value_type>(this, n);
+        }
+
+    private:
+        template <typename Element, typename Self>
+        static generator<std::span<Element>> chunks_of(Self* self, const size_type n) {
+            for (size_type offset = 0; offset < self->size_; offset += n) {
+                co_yield std::span<Element>(std::to_address(self->data_) + offset, std::min(n, self->size_ - offset));
+            }
+        }
+
+    public:
+
         void pop_back() {
+            NP_VECTOR_TRACE_EVENT(pop_back, 0, 0);
+
             allocator_traits::destroy(allocator_, data_ + --size_);
+            if (shrink_ != nullptr) {
+                maybe_shrink();
+            }
         }
 
         void clear() {
+            NP_VECTOR_TRACE_EVENT(clear, 0, 0);
+
             for (; size_ > 0; --size_) {
                 allocator_traits::destroy(allocator_, data_ + size_ - 1);
             }
+            if (shrink_ != nullptr) {
+                maybe_shrink();
+            }
         }
 
-        void shrink_to_fit() {
-            if (size_ < capacity_) {
-                pointer new_arr = allocator_traits::allocate(allocator_, size_);
+        // Enables automatic shrinking; see np::shrink_policy.
+        void set_shrink_policy(const shrink_policy& policy) {
+            if (policy.shrink_below < 2 || policy.keep_factor == 0 || policy.keep_factor >= policy.shrink_below) {
+                NP_VECTOR_THROW(std::invalid_argument("Shrink policy needs 1 <= keep_factor < shrink_below"));
+            }
 
-                size_type index = 0;
-                try {
-                    for (; index < size_; ++index) {
-                        allocator_traits::construct(allocator_, new_arr + index, data_[index]);
-                    }
-                } catch (...) {
-                    for (; index > 0; --index) {
-                        allocator_traits::destroy(allocator_, new_arr + index - 1);
-                    }
+            shrink_state& state = shrink_control();
+            state.policy = policy;
+            state.automatic = true;
+            maybe_shrink();
+        }
 
-                    allocator_traits::deallocate(allocator_, new_arr, size_);
-                    throw;
-                }
+        void clear_shrink_policy() noexcept {
+            if (shrink_ != nullptr) {
+                shrink_->automatic = false;
+            }
+        }
 
-                for (size_type i = size_; i < capacity_; ++i) {
-                    allocator_traits::destroy(allocator_, data_ + i);
-                }
+        // Adds this vector to registry, so it trims itself to its size after registry.request_trim()
+        // (see np::trim_registry). A vector belongs to at most one registry; it leaves on destruction,
+        // untrack() or freeze(). Move construction and move assignment hand the membership and shrink
+        // policy to the target.
+        void track(trim_registry& registry = trim_registry::global()) {
+            registry.add(shrink_control());
+        }
 
-                allocator_traits::deallocate(allocator_, data_, capacity_);
+        // Trims to size if this vector's registry requested a trim since the last check. For vectors
+        // that sit idle instead of removing elements; returns whether it trimmed.
+        bool trim_if_requested() {
+            return shrink_ != nullptr && trim_on_request();
+        }
 
-                data_ = new_arr;
-                capacity_ = size_;
+        void untrack() noexcept {
+            if (shrink_ != nullptr) {
+                shrink_->leave();
+            }
+        }
+
+        void shrink_to_fit() {
+            NP_VECTOR_TRACE_EVENT(shrink_to_fit, 0, 0);
+
+            if (size_ < capacity_) {
+                shrink_capacity(size_);
             }
         }
 
-       void resize(const size_type count) {
+        void resize(const size_type count) {
+            NP_VECTOR_TRACE_EVENT(resize, count, 0);
+
             if (count > capacity_) {
-                reserve(count);
+                reallocate(count);
             }
 
-            if (count == 0) {
-                clear();
+            if (count > size_) {
+                // size_ follows the loop, so elements built before a throwing constructor are kept.
+                for (; size_ < count; ++size_) {
+                    allocator_traits::construct(allocator_, data_ + size_, value_type());
+                }
             }
             else {
-                if (count > size_) {
-                    try {
-                        for (size_type i = size_; i < count; ++i) {
-                            allocator_traits::construct(allocator_, data_ + i, value_type());
-                        }
-                    } catch (...) {
-                        throw;
-                    }
-                }
-                else {
-                    for (size_type i = count; i < size_; ++i) {
-                        allocator_traits::destroy(allocator_, data_ + i);
-                    }
+                for (size_type i = count; i < size_; ++i) {
+                    allocator_traits::destroy(allocator_, data_ + i);
                 }
             }
 
             size_ = count;
+            if (shrink_ != nullptr) {
+                maybe_shrink();
+            }
         }
 
         void resize(const size_type count, const_reference value) {
+            NP_VECTOR_TRACE_EVENT(resize, count, 0);
+
             if (count > capacity_) {
-                reserve(count);
+                reallocate(count);
             }
 
-            if (count == 0) {
-                clear();
+            if (count > size_) {
+                for (; size_ < count; ++size_) {
+                    allocator_traits::construct(allocator_, data_ + size_, value);
+                }
             }
             else {
-                if (count > size_) {
-                    try {
-                        for (size_type i = size_; i < count; ++i) {
-                            allocator_traits::construct(allocator_, data_ + i, value);
-                        }
-                    } catch (...) {
-                        throw;
-                    }
-                }
-                else {
-                    for (size_type i = count; i < size_; ++i) {
-                        allocator_traits::destroy(allocator_, data_ + i);
-                    }
+                for (size_type i = count; i < size_; ++i) {
+                    allocator_traits::destroy(allocator_, data_ + i);
                 }
             }
 
             size_ = count;
+            if (shrink_ != nullptr) {
+                maybe_shrink();
+            }
+        }
+
+        // Grows with the new elements constructed on the policy's threads; shrinking is the same as resize(count).
+        // Existing elements are relocated on the calling thread if the buffer has to grow.
+        void resize(const parallel_policy& policy, const size_type count) {
+            if (count <= size_) {
+                resize(count);
+                return;
+            }
+
+            NP_VECTOR_TRACE_EVENT(resize, count, 0);
+            if (count > capacity_) {
+                reallocate(count);
+            }
+
+            parallel_construct(policy, size_, count - size_);
+            size_ = count;
+        }
+
+        void resize(const parallel_policy& policy, const size_type count, const_reference value) {
+            if (count <= size_) {
+                resize(count);
+                return;
+            }
+
+            NP_VECTOR_TRACE_EVENT(resize, count, 0);
+            if (count > capacity_) {
+                // value may be an element of this vector, so keep a copy across the reallocation.
+                const value_type copy(value);
+                reallocate(count);
+                parallel_construct(policy, size_, count - size_, copy);
+            }
+            else {
+                parallel_construct(policy, size_, count - size_, value);
+            }
+            size_ = count;
         }
 
         [[nodiscard]] size_type size() const noexcept { return size_; }
         [[nodiscard]] size_type capacity() const noexcept { return capacity_; }
+        [[nodiscard]] size_type max_size() const noexcept { return allocator_traits::max_size(allocator_); }
+
+        allocator_type get_allocator() const noexcept { return allocator_; }
 
         iterator insert(const_iterator pos, const_reference value) {
-            difference_type index = pos.ptr_ - data_;
-            if (size_ > capacity_ - 1) {
-                reserve(capacity_ ? capacity_ * 2 : 1);
+            const difference_type index = pos.ptr_ - data_;
+            if (index < 0 || index > static_cast<difference_type>(size_)) {
+                NP_VECTOR_THROW(std::out_of_range("Iterator out of range"));
             }
 
-            const_pointer ptr = data_ + index;
+            return insert_at(static_cast<size_type>(index), value, [this](const size_type at, const_reference element) {
+                if (size_ == capacity_) {
+                    reallocate(next_capacity());
+                }
+                return insert_unchecked(at, element);
+            });
+        }
 
-            if (ptr < data_ + size_) {
-                std::uninitialized_copy(ptr, data_ + size_, ptr + 1);
-                allocator_traits::destroy(allocator_, ptr);
+        // Non-throwing insert(): fails with out_of_range for a position outside [begin(), end()] and
+        // with out_of_memory or length_exceeded if the buffer can't grow; the vector is then unchanged.
+        [[nodiscard]] std::expected<iterator, vector_error> try_insert(const_iterator pos, const_reference value) {
+            const difference_type index = pos.ptr_ - data_;
+            if (index < 0 || index > static_cast<difference_type>(size_)) {
+                return std::unexpected(vector_error::out_of_range);
             }
 
-            allocator_traits::construct(allocator_, ptr, value);
-            ++size_;
+            vector_error error{};
+            iterator result = insert_at(static_cast<size_type>(index), value, [this, &error](const size_type at, const_reference element) {
+                if (size_ == capacity_) {
+                    error = try_reallocate(next_capacity());
+                    if (error != vector_error{}) {
+                        return end();
+                    }
+                }
+                return insert_unchecked(at, element);
+            });
 
-            return iterator(data_ + index, data_, data_ + size_);
+            if (error != vector_error{}) {
+                return std::unexpected(error);
+            }
+            return result;
         }
 
         iterator erase(iterator pos) {
             if (pos.ptr_ < data_ || pos.ptr_ >= data_ + size_) {
-                throw std::out_of_range("Iterator out of range");
+                NP_VECTOR_THROW(std::out_of_range("Iterator out of range"));
             }
 
             pointer ptr = pos.ptr_;
@@ -450,28 +1186,43 @@ namespace np {
 
             --size_;
 
-            return iterator(ptr, data_, data_ + size_);
+            const difference_type index = ptr - data_;
+            NP_VECTOR_TRACE_EVENT(erase, index, 1);
+
+            if (shrink_ != nullptr) {
+                maybe_shrink();
+            }
+
+            return make_iterator<false>(data_ + index);
         }
 
         iterator erase(iterator first, iterator last) {
-            if (first.ptr_ < data_ || first.ptr_ >= data_ + size_ || last.ptr_ < data_ || last.ptr_ > data_ + size_ || first.ptr_ > last.ptr_) {
-                throw std::out_of_range("Iterator out of range");
+            if (first.ptr_ < data_ || last.ptr_ > data_ + size_ || first.ptr_ > last.ptr_) {
+                NP_VECTOR_THROW(std::out_of_range("Iterator out of range"));
             }
 
             pointer ptr_first = first.ptr_;
             pointer ptr_last = last.ptr_;
+            const size_type count = static_cast<size_type>(ptr_last - ptr_first);
 
             for (pointer p = ptr_last; p != data_ + size_; ++p) {
-                *(p - std::distance(ptr_first, ptr_last)) = *p;
+                *(p - count) = *p;
             }
 
-            for (size_type i = 0; i < std::distance(ptr_first, ptr_last); ++i) {
-                allocator_traits::destroy(allocator_, data_ + size_ - i);
+            for (size_type i = 0; i < count; ++i) {
+                allocator_traits::destroy(allocator_, data_ + size_ - 1 - i);
             }
 
-            size_ -= std::distance(ptr_first, ptr_last);
+            size_ -= count;
+
+            const difference_type index = ptr_first - data_;
+            NP_VECTOR_TRACE_EVENT(erase, index, count);
+
+            if (shrink_ != nullptr) {
+                maybe_shrink();
+            }
 
-            return iterator(ptr_first, data_, data_ + size_);
+            return make_iterator<false>(data_ + index);
         }
 
         iterator erase(const_iterator pos) {
@@ -484,11 +1235,13 @@ namespace np {
 
         [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
 
-        iterator begin() noexcept { return iterator(data_); }
-        const_iterator cbegin() const noexcept { return const_iterator(data_); }
+        iterator begin() noexcept { return make_iterator<false>(data_); }
+        const_iterator begin() const noexcept { return make_iterator<true>(data_); }
+        const_iterator cbegin() const noexcept { return make_iterator<true>(data_); }
 
-        iterator end() noexcept { return iterator(data_ + size_); }
-        const_iterator cend() const noexcept { return const_iterator(data_ + size_); }
+        iterator end() noexcept { return make_iterator<false>(data_ + size_); }
+        const_iterator end() const noexcept { return make_iterator<true>(data_ + size_); }
+        const_iterator cend() const noexcept { return make_iterator<true>(data_ + size_); }
 
         reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
         const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
@@ -499,6 +1252,18 @@ namespace np {
         const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
         const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
 
+        pointer data() noexcept { return data_; }
+        const_pointer data() const noexcept { return data_; }
+
+        // data() with the allocator's alignment guarantee attached, so loops over it can use aligned loads.
+        pointer aligned_data() noexcept {
+            return std::assume_aligned<allocator_alignment_v<allocator_type>>(std::to_address(data_));
+        }
+
+        const_pointer aligned_data() const noexcept {
+            return std::assume_aligned<allocator_alignment_v<allocator_type>>(std::to_address(data_));
+        }
+
         reference front() { return *data_; }
         const_reference front() const { return *data_; }
 
@@ -515,7 +1280,7 @@ namespace np {
 
         reference at(const size_type index) {
             if (index >= size_) {
-                throw std::out_of_range("Index out of range");
+                NP_VECTOR_THROW(std::out_of_range("Index out of range"));
             }
 
             return data_[index];
@@ -523,13 +1288,18 @@ namespace np {
 
         const_reference at(const size_type index) const {
             if (index >= size_) {
-                throw std::out_of_range("Index out of range");
+                NP_VECTOR_THROW(std::out_of_range("Index out of range"));
             }
 
             return data_[index];
         }
 
         ~vector() {
+            NP_VECTOR_TRACE_EVENT(destroy, 0, 0);
+
+            // Leave the trim registry before the buffer goes away.
+            untrack();
+
             if (data_) {
                 for (size_type i = 0; i < size_; ++i) {
                     allocator_traits::destroy(allocator_, data_ + i);
@@ -539,144 +1309,7 @@ namespace np {
             }
         }
     };
-}
-
-template<>
-    class vector<bool> {
-
-        struct Bit_reference {
-            std::uint8_t* bucket_ptr_;
-            std::uint8_t  pos_;
-
-            Bit_reference(std::uint8_t* ptr, const std::uint8_t pos) : bucket_ptr_(ptr), pos_(pos) {}
-
-            Bit_reference operator=(bool bit) {
-                bit ? *bucket_ptr_ |= (static_cast<uint8_t>(1) << pos_) : *bucket_ptr_ &= ~(static_cast<uint8_t>(1) << pos_);
-                return *this;
-            }
-
-            operator bool() const {
-                return *bucket_ptr_ & (1 << pos_);
-            }
-        };
-
-        uint8_t* arr_;
-        std::size_t size_;
-        std::size_t capacity_;
-
-    public:
-        Bit_reference operator[](std::size_t index) {
-            std::uint8_t pos = index % 8;
-            std::uint8_t* ptr = arr_ + index / 8;
-
-            return Bit_reference(ptr, pos);
-        }
 
-        vector(const std::initializer_list<bool>& list) {
-            size_ = list.size();
-            capacity_ = (size_ + 7) / 8;
-            arr_ = new uint8_t[capacity_]();
-
-            std::size_t i = 0;
-            for (bool value : list) {
-                if (value) {
-                    arr_[i / 8] |= (static_cast<uint8_t>(1) << (i % 8));
-                }
-                ++i;
-            }
-        }
-
-        vector& operator=(const vector& other) {
-            if (this != &other) {
-                size_ = other.size_;
-                capacity_ = other.capacity_;
-                arr_ = new uint8_t[capacity_];
-                std::copy(other.arr_, other.arr_ + capacity_, arr_);
-            }
-            return *this;
-        }
-
-        std::size_t size() const {
-            return size_;
-        }
-
-        std::size_t capacity() const {
-            return capacity_;
-        }
-
-        void pop_back() {
-            if (size_ == 0) {
-                throw std::out_of_range("Cannot pop from an empty vector");
-            }
-            --size_;
-            if (arr_ != nullptr) {
-                std::size_t pos = size_ % 8;
-                arr_[size_ / 8] &= ~(static_cast<uint8_t>(1) << (7 - pos));
-            }
-        }
-
-        void push_back(bool value) {
-            if (size_ == capacity_ * 8) {
-                reserve(capacity_ == 0 ? 1 : capacity_ * 2);
-            }
-            if (value) {
-                arr_[size_ / 8] |= (static_cast<uint8_t>(1) << (size_ % 8));
-            }
-            ++size_;
-        }
-
-        void reserve(std::size_t new_capacity) {
-            if (new_capacity == capacity_) {
-                return;
-            }
-            else if (new_capacity < capacity_) {
-                std::size_t new_size = std::min(new_capacity, size_);
-                std::size_t new_byte_capacity = (new_capacity + 7) / 8;
-                uint8_t* new_arr = new uint8_t[new_byte_capacity]();
-
-                if (arr_ != nullptr) {
-                    std::size_t current_byte_capacity = (capacity_ + 7) / 8;
-                    std::copy(arr_, arr_ + std::min(current_byte_capacity, new_byte_capacity), new_arr);
-                    delete[] arr_;
-                }
-
-                arr_ = new_arr;
-                capacity_ = new_capacity;
-                size_ = new_size;
-            }
-            else {
-                std::size_t new_byte_capacity = (new_capacity + 7) / 8;
-                uint8_t* new_arr = new uint8_t[new_byte_capacity]();
-
-                if (arr_ != nullptr) {
-                    std::size_t current_byte_capacity = (capacity_ + 7) / 8;
-                    std::copy(arr_, arr_ + current_byte_capacity, new_arr);
-                    delete[] arr_;
-                }
-
-                arr_ = new_arr;
-                capacity_ = new_capacity;
-            }
-        }
-
-        void resize(std::size_t new_size, bool value = false) {
-            reserve(new_size);
-            for (std::size_t i = size_; i < new_size; ++i) {
-                (*this)[i] = value;
-            }
-            size_ = new_size;
-        }
-
-        void clear() {
-            delete[] arr_;
-            arr_ = nullptr;
-            size_ = 0;
-            capacity_ = 0;
-        }
-
-        vector() = default;
-
-        ~vector() {
-            delete[] arr_;
-        }
-    };
+    template <typename T, std::size_t Alignment = 64, std::size_t Padding = 0>
+    using aligned_vector = vector<T, aligned_allocator<T, Alignment, Padding>>;
+}
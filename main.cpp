@@ -1,7 +1,30 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
 #include <cassert>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
 
 #include "containers/vector/vector.hpp"
+#include "containers/vector/simd.hpp"
+#include "containers/vector/trace.hpp"
+#include "containers/vector/cow_vector.hpp"
+#include "containers/vector/pool_allocator.hpp"
+#include "containers/vector/sort.hpp"
+#include "containers/vector/double_buffer.hpp"
+#include "containers/vector/frozen_vector.hpp"
+#include "containers/packed_vector/packed_vector.hpp"
+#include "containers/devector/devector.hpp"
 
 void test_push_back_and_size() {
     np::vector<int> vec;
@@ -146,6 +169,1250 @@ void test_iterators() {
     assert(sum == 6);
 }
 
+void test_iterator_concepts() {
+    static_assert(std::contiguous_iterator<np::vector<int>::iterator>);
+    static_assert(std::contiguous_iterator<np::vector<int>::const_iterator>);
+    static_assert(std::is_same_v<std::iter_reference_t<np::vector<int>::const_iterator>, const int&>);
+#if !defined(NP_VECTOR_CHECKED_ITERATORS)
+    static_assert(sizeof(np::vector<int>::iterator) == sizeof(int*));
+#endif
+
+    np::vector<int> vec;
+    for (int i = 5; i > 0; --i) {
+        vec.push_back(i);
+    }
+    std::sort(vec.begin(), vec.end());
+    assert(std::is_sorted(vec.cbegin(), vec.cend()));
+    assert(std::to_address(vec.begin()) == &vec[0]);
+    assert(vec.begin()[4] == 5);
+
+    const np::vector<int>& cref = vec;
+    np::vector<int>::const_iterator it = vec.begin();
+    ++it;
+    assert(*it == 2);
+    assert(cref.end() - cref.begin() == 5);
+
+    // Mixed iterator / const_iterator arithmetic and comparison.
+    assert(vec.end() - vec.cbegin() == 5);
+    assert(vec.cend() - vec.begin() == 5);
+    assert(vec.begin() < vec.cend());
+    assert(vec.cend() > vec.begin());
+    assert(vec.begin() == vec.cbegin());
+    assert(vec.cbegin() != vec.end());
+    static_assert(std::sized_sentinel_for<np::vector<int>::const_iterator, np::vector<int>::iterator>);
+}
+
+void test_copy_tight_capacity() {
+    np::vector<int> vec;
+    vec.reserve(100);
+    vec.push_back(1);
+    vec.push_back(2);
+
+    np::vector<int> copy(vec);
+    assert(copy.size() == 2);
+    assert(copy.capacity() == 2);
+    assert(copy[0] == 1 && copy[1] == 2);
+
+    np::vector<int> empty;
+    np::vector<int> empty_copy(empty);
+    assert(empty_copy.empty());
+    assert(empty_copy.capacity() == 0);
+}
+
+void test_copy_assignment_reuses_storage() {
+    np::vector<int> src;
+    src.push_back(7);
+    src.push_back(8);
+
+    np::vector<int> dst;
+    dst.reserve(10);
+    dst.push_back(1);
+    const int* storage = &dst.front();
+    dst = src;
+    assert(dst.capacity() == 10);
+    assert(&dst.front() == storage);
+    assert(dst.size() == 2 && dst[0] == 7 && dst[1] == 8);
+
+    np::vector<std::string> strings{"a", "b", "c"};
+    np::vector<std::string> other{"x"};
+    strings = other;
+    assert(strings.size() == 1 && strings[0] == "x");
+    other = strings;
+    assert(other.size() == 1 && other[0] == "x");
+
+    np::vector<std::string> grown;
+    grown = np::vector<std::string>{"p", "q", "r"};
+    assert(grown.size() == 3 && grown[2] == "r");
+}
+
+void test_aligned_vector() {
+    np::aligned_vector<float, 64, 32> vec;
+    for (int i = 0; i < 100; ++i) {
+        vec.push_back(static_cast<float>(i));
+        assert(reinterpret_cast<std::uintptr_t>(vec.data()) % 64 == 0);
+    }
+    assert(vec.aligned_data() == vec.data());
+    assert(vec[99] == 99.0f);
+
+    np::aligned_vector<float, 64, 32> copy(vec);
+    assert(reinterpret_cast<std::uintptr_t>(copy.data()) % 64 == 0);
+    assert(copy[50] == 50.0f);
+
+    static_assert(np::aligned_allocator<float, 64, 32>::storage_size(1) == 64);
+    static_assert(np::aligned_allocator<float, 32, 32>::storage_size(8) == 64);
+    static_assert(np::allocator_alignment_v<std::allocator<double>> == alignof(double));
+}
+
+template <typename T>
+void check_simd_kernels(const std::size_t n) {
+    np::vector<T> values;
+    np::vector<T> other;
+    for (std::size_t i = 0; i < n; ++i) {
+        values.push_back(static_cast<T>((i * 37) % 101) - T(50));
+        other.push_back(static_cast<T>(i % 7));
+    }
+
+    T sum = 0;
+    T dot = 0;
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        sum += values[i];
+        dot += values[i] * other[i];
+        count += values[i] == T(3);
+    }
+    assert(np::simd::sum(values) == sum);
+    assert(np::simd::dot(values, other) == dot);
+    assert(np::simd::count(values, T(3)) == count);
+    assert(np::simd::find(values, T(1000)) == n);
+
+    if (n != 0) {
+        const auto [lo, hi] = np::simd::min_max(values);
+        assert(lo == *std::min_element(values.begin(), values.end()));
+        assert(hi == *std::max_element(values.begin(), values.end()));
+
+        const T needle = values[n - 1];
+        assert(np::simd::find(values, needle) == static_cast<std::size_t>(std::find(values.begin(), values.end(), needle) - values.begin()));
+    }
+
+    np::vector<T> scaled(values);
+    np::simd::scale(scaled, T(3));
+    np::simd::axpy(T(2), other, scaled);
+    np::simd::clamp(scaled, T(-40), T(40));
+    for (std::size_t i = 0; i < n; ++i) {
+        assert(scaled[i] == std::clamp(values[i] * T(3) + T(2) * other[i], T(-40), T(40)));
+    }
+}
+
+// NaN handling has to match the scalar kernels on every instruction set.
+template <typename T>
+void check_simd_nan() {
+    const T nan = std::numeric_limits<T>::quiet_NaN();
+
+    np::vector<T> values;
+    values.push_back(nan);
+    for (int i = 0; i < 40; ++i) {
+        values.push_back(static_cast<T>(i));
+    }
+
+    auto [lo, hi] = np::simd::min_max(values);
+    assert(std::isnan(lo) && std::isnan(hi));
+
+    values[0] = T(5);
+    values[17] = nan;
+    std::tie(lo, hi) = np::simd::min_max(values);
+    assert(lo == T(0) && hi == T(39));
+
+    np::simd::clamp(values, T(2), T(30));
+    assert(std::isnan(values[17]));
+    assert(values[1] == T(2) && values[40] == T(30) && values[10] == T(9));
+    assert(np::simd::count(values, nan) == 0);
+}
+
+void test_simd_kernels() {
+    const np::simd::isa supported = np::simd::supported_isa();
+    for (auto level : {np::simd::isa::scalar, np::simd::isa::sse2, np::simd::isa::avx2, np::simd::isa::avx512}) {
+        if (level > supported) {
+            break;
+        }
+
+        np::simd::set_active_isa(level);
+        assert(np::simd::active_isa() == level);
+        for (std::size_t n : {0, 1, 7, 33, 1000}) {
+            check_simd_kernels<float>(n);
+            check_simd_kernels<double>(n);
+            check_simd_kernels<int>(n);
+            check_simd_kernels<std::int64_t>(n);
+        }
+        check_simd_nan<float>();
+        check_simd_nan<double>();
+
+        // Unsigned sums wrap the same way on every path.
+        np::vector<std::uint32_t> wrapping(100, 0xF000'0000u);
+        assert(np::simd::sum(wrapping) == static_cast<std::uint32_t>(100u * 0xF000'0000u));
+        assert(np::simd::count(wrapping, 0xF000'0000u) == 100);
+    }
+    np::simd::set_active_isa(supported);
+
+    try {
+        np::simd::min_max(np::vector<float>());
+        assert(false);
+    }
+    catch (const std::out_of_range&) {
+    }
+}
+
+void test_move() {
+    np::vector<int> vec{1, 2, 3};
+    const int* storage = vec.data();
+
+    np::vector<int> moved(std::move(vec));
+    assert(moved.data() == storage);
+    assert(moved.size() == 3);
+    assert(vec.empty() && vec.capacity() == 0);
+
+    np::vector<int> assigned{9};
+    assigned = std::move(moved);
+    assert(assigned.data() == storage);
+    assert(assigned[2] == 3);
+}
+
+void test_freeze() {
+    np::vector<int> vec{1, 2, 3};
+    const int* storage = vec.data();
+
+    np::frozen_vector<int> frozen = std::move(vec).freeze();
+    assert(frozen.data() == storage);
+    assert(frozen.size() == 3 && frozen[1] == 2);
+
+    np::frozen_vector<int> reader = frozen;
+    assert(reader.data() == storage);
+    assert(frozen.use_count() == 2);
+
+    std::span<const int> view = reader;
+    assert(view.size() == 3 && view.back() == 3);
+
+    // Moved-from snapshots are empty, not dangling.
+    np::frozen_vector<int> moved(std::move(reader));
+    assert(moved.data() == storage);
+    assert(reader.size() == 0 && reader.empty() && reader.begin() == reader.end());
+    reader = std::move(moved);
+    assert(moved.empty() && reader.size() == 3);
+    assert(np::frozen_vector<int>().empty());
+}
+
+void test_cow_vector() {
+    np::cow_vector<int> cow(np::vector<int>{1, 2, 3});
+    cow.push_back(4);
+    assert(cow.size() == 4);
+    const int* storage = cow.data();
+
+    np::frozen_vector<int> snapshot = cow.snapshot();
+    assert(snapshot.data() == storage);
+    assert(cow.shared());
+
+    cow.set(0, 10);
+    assert(cow[0] == 10);
+    assert(snapshot[0] == 1);
+    assert(snapshot.size() == 4);
+    assert(!cow.shared());
+
+    np::cow_vector<int> adopted(snapshot);
+    assert(adopted.data() == snapshot.data());
+    adopted.clear();
+    assert(adopted.empty() && snapshot.size() == 4);
+
+    // Writes after a snapshot never reach it.
+    np::cow_vector<int> writer(np::vector<int>{1, 2});
+    np::frozen_vector<int> before = writer.snapshot();
+    writer.push_back(7);
+    np::frozen_vector<int> after = writer.snapshot();
+    writer.set(0, 5);
+    assert(before.size() == 2 && after.size() == 3 && after[0] == 1);
+    assert(writer[0] == 5);
+
+    // Moved-from and default-constructed cow_vectors are empty and still writable.
+    np::cow_vector<int> moved(std::move(writer));
+    assert(moved.size() == 3 && writer.size() == 0 && writer.empty());
+    writer.push_back(1);
+    assert(writer.size() == 1 && moved.size() == 3);
+    writer = std::move(moved);
+    assert(writer.size() == 3 && moved.empty());
+
+    np::cow_vector<int> fresh;
+    np::frozen_vector<int> empty_snapshot = fresh.snapshot();
+    fresh.push_back(3);
+    assert(empty_snapshot.empty() && fresh.size() == 1);
+    assert(np::cow_vector<int>().empty());
+}
+
+void test_atomic_frozen_vector() {
+    np::atomic_frozen_vector<int> published(np::vector<int>{1, 2}.freeze());
+
+    np::frozen_vector<int> before = published.load();
+    np::frozen_vector<int> after = published.update([](np::vector<int>& vec) { vec.push_back(3); });
+
+    assert(before.size() == 2);
+    assert(after.size() == 3 && after[2] == 3);
+    assert(published.load().data() == after.data());
+
+    np::frozen_vector<int> old = published.exchange(np::vector<int>{7}.freeze());
+    assert(old.data() == after.data());
+    assert(published.load()[0] == 7);
+}
+
+void test_packed_vector() {
+    np::packed_vector packed;
+    np::vector<std::uint64_t> reference;
+    for (std::uint64_t i = 0; i < 1000; ++i) {
+        const std::uint64_t value = (i * 2654435761u) % (i < 500 ? 100 : 5000);
+        packed.push_back(value);
+        reference.push_back(value);
+    }
+    assert(packed.width() == 13);
+    assert(packed.size() == 1000);
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        assert(packed[i] == reference[i]);
+    }
+
+    packed.set(10, std::uint64_t(1) << 63);
+    reference[10] = std::uint64_t(1) << 63;
+    assert(packed.width() == 64);
+    assert(packed.at(10) == reference[10]);
+    assert(packed[999] == reference[999]);
+
+    np::vector<std::uint64_t> unpacked;
+    packed.unpack(unpacked);
+    assert(unpacked.size() == reference.size());
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        assert(unpacked[i] == reference[i]);
+    }
+
+    np::packed_vector small(np::vector<std::uint64_t>(4096, 1000));
+    assert(small.width() == 10);
+    assert(small.memory_bytes() * 6 < 4096 * sizeof(std::uint64_t));
+
+    np::packed_vector zeros{0, 0, 0};
+    assert(zeros.width() == 0 && zeros[2] == 0);
+    np::vector<std::uint64_t> unpacked_zeros{7};
+    zeros.unpack(unpacked_zeros);
+    assert(unpacked_zeros.size() == 4 && unpacked_zeros[0] == 7 && unpacked_zeros[3] == 0);
+
+    try {
+        small.at(4096);
+        assert(false);
+    }
+    catch (const std::out_of_range&) {
+    }
+}
+
+void test_packed_delta_vector() {
+    np::vector<std::uint64_t> sorted;
+    for (std::uint64_t i = 0; i < 10000; ++i) {
+        sorted.push_back(1'000'000'000'000 + i * 3 + (i % 2));
+    }
+
+    np::packed_delta_vector packed(sorted);
+    assert(packed.size() == sorted.size());
+    assert(packed.memory_bytes() * 4 < sorted.size() * sizeof(std::uint64_t));
+    for (std::size_t i = 0; i < sorted.size(); ++i) {
+        assert(packed[i] == sorted[i]);
+    }
+
+    np::vector<std::uint64_t> unpacked;
+    packed.unpack(unpacked);
+    for (std::size_t i = 0; i < sorted.size(); ++i) {
+        assert(unpacked[i] == sorted[i]);
+    }
+
+    np::packed_delta_vector unsorted{50, 40, 60, 10, 1000, 0, ~std::uint64_t(0)};
+    assert(unsorted[0] == 50 && unsorted[3] == 10 && unsorted[5] == 0);
+    assert(unsorted.at(6) == ~std::uint64_t(0));
+
+    // Width-0 blocks: a whole constant block followed by a constant last block.
+    np::vector<std::uint64_t> constant(np::packed_delta_vector::block_size, 9);
+    constant.push_back(4);
+    constant.push_back(4);
+    constant.push_back(4);
+    np::packed_delta_vector equal(constant);
+    np::vector<std::uint64_t> unpacked_equal;
+    equal.unpack(unpacked_equal);
+    assert(unpacked_equal.size() == constant.size());
+    for (std::size_t i = 0; i < constant.size(); ++i) {
+        assert(unpacked_equal[i] == constant[i] && equal[i] == constant[i]);
+    }
+}
+
+void test_trace_roundtrip() {
+    std::stringstream buffer;
+    {
+        np::trace::writer writer(buffer);
+        writer.write({np::trace::op::reserve, 3, 1000, 0});
+        writer.write({np::trace::op::push_back, 3, 0, 0});
+        writer.write({np::trace::op::erase, 300, 5, 2});
+        writer.write({np::trace::op::destroy, 3, 0, 0});
+    }
+
+    np::trace::reader reader(buffer);
+    np::trace::event record;
+    assert(reader.next(record) && record.type == np::trace::op::reserve && record.vector_id == 3 && record.first == 1000);
+    assert(reader.next(record) && record.type == np::trace::op::push_back);
+    assert(reader.next(record) && record.type == np::trace::op::erase && record.vector_id == 300 && record.first == 5 && record.second == 2);
+    assert(reader.next(record) && record.type == np::trace::op::destroy);
+    assert(!reader.next(record));
+
+    std::stringstream garbage("not a trace");
+    try {
+        np::trace::reader invalid(garbage);
+        assert(false);
+    }
+    catch (const std::runtime_error&) {
+    }
+}
+
+void test_pool_allocator() {
+    const np::pool_stats before = np::pool_statistics();
+
+    np::pool_allocator<int> allocator;
+    int* first = allocator.allocate(100);
+    allocator.deallocate(first, 100);
+    int* second = allocator.allocate(128);
+    assert(second == first);
+    allocator.deallocate(second, 128);
+
+    {
+        np::vector<int, np::pool_allocator<int>> vec;
+        for (int i = 0; i < 1000; ++i) {
+            vec.push_back(i);
+        }
+        assert(vec[999] == 999);
+    }
+
+    const np::pool_stats after = np::pool_statistics();
+    assert(after.allocations - before.allocations == after.deallocations - before.deallocations);
+    assert(after.cache_hits > before.cache_hits);
+    assert(after.cached_bytes > 0);
+}
+
+void test_pool_allocator_remote_free() {
+    np::pool_allocator<double> allocator;
+    np::vector<double*> blocks;
+    for (int i = 0; i < 100; ++i) {
+        blocks.push_back(allocator.allocate(64));
+    }
+
+    const np::pool_stats before = np::pool_statistics();
+    std::thread([&] {
+        for (std::size_t i = 0; i < blocks.size(); ++i) {
+            allocator.deallocate(blocks[i], 64);
+        }
+    }).join();
+
+    const np::pool_stats after = np::pool_statistics();
+    assert(after.remote_frees - before.remote_frees == 100);
+    assert(after.remote_batches - before.remote_batches == 4);
+
+    double* reused = allocator.allocate(64);
+    assert(std::find(blocks.begin(), blocks.end(), reused) != blocks.end());
+    allocator.deallocate(reused, 64);
+}
+
+void test_pool_allocator_pending_flush() {
+    np::pool_allocator<double> allocator;
+    np::vector<double*> blocks;
+    for (int i = 0; i < 10; ++i) {
+        blocks.push_back(allocator.allocate(64));
+    }
+
+    // A long-lived thread that frees fewer than a batch of remote blocks hands them back once it has
+    // freed enough of its own, or when it calls pool_flush(), not only when it exits.
+    std::atomic<int> stage{0};
+    np::pool_stats before = np::pool_statistics();
+    std::thread consumer([&] {
+        for (int i = 0; i < 5; ++i) {
+            allocator.deallocate(blocks[i], 64);
+        }
+        for (int i = 0; i < 300; ++i) {
+            allocator.deallocate(allocator.allocate(64), 64);
+        }
+        stage.store(1);
+        stage.notify_one();
+        stage.wait(1);
+
+        for (int i = 5; i < 10; ++i) {
+            allocator.deallocate(blocks[i], 64);
+        }
+        np::pool_flush();
+        stage.store(3);
+        stage.notify_one();
+        stage.wait(3);
+    });
+
+    stage.wait(0);
+    np::pool_stats after = np::pool_statistics();
+    assert(after.remote_frees - before.remote_frees == 5);
+    assert(after.remote_batches - before.remote_batches == 1);
+
+    before = after;
+    stage.store(2);
+    stage.notify_one();
+    while (stage.load() != 3) {
+        stage.wait(2);
+    }
+    after = np::pool_statistics();
+    assert(after.remote_batches - before.remote_batches == 1);
+
+    stage.store(4);
+    stage.notify_one();
+    consumer.join();
+
+    // Blocks freed to the cache of an exited thread go back to the system instead of queueing on it,
+    // so the next thread, which adopts that cache, has nothing to reuse.
+    double* orphaned_block = nullptr;
+    std::thread([&] { orphaned_block = allocator.allocate(64); }).join();
+    before = np::pool_statistics();
+    allocator.deallocate(orphaned_block, 64);
+    np::pool_flush();
+    std::thread([&] { allocator.deallocate(allocator.allocate(64), 64); }).join();
+    after = np::pool_statistics();
+    assert(after.remote_frees - before.remote_frees == 1);
+    assert(after.remote_batches - before.remote_batches == 1);
+    assert(after.cache_hits == before.cache_hits);
+    assert(after.system_allocations - before.system_allocations == 1);
+}
+
+void test_devector_push_front() {
+    np::devector<int> dev;
+    for (int i = 0; i < 1'000'000; ++i) {
+        dev.push_front(i);
+    }
+    assert(dev.size() == 1'000'000);
+    assert(dev.front() == 999'999 && dev.back() == 0);
+    assert(dev.capacity() < 4'000'000);
+
+    dev.push_back(-1);
+    dev.pop_front();
+    assert(dev.front() == 999'998 && dev.back() == -1);
+    dev.pop_back();
+    assert(dev.back() == 0);
+
+    long long sum = 0;
+    for (int value : dev) {
+        sum += value;
+    }
+    assert(sum == 999'998LL * 999'999 / 2);
+    assert(std::span<const int>(dev.data(), dev.size())[0] == 999'998);
+}
+
+void test_devector_insert_erase() {
+    np::devector<std::string> dev{"a", "b", "c", "d", "e", "f"};
+
+    dev.insert(dev.cbegin() + 1, "x");
+    dev.insert(dev.cend() - 1, "y");
+    const char* expected[] = {"a", "x", "b", "c", "d", "e", "y", "f"};
+    assert(dev.size() == 8);
+    for (std::size_t i = 0; i < dev.size(); ++i) {
+        assert(dev[i] == expected[i]);
+    }
+
+    auto it = dev.erase(dev.cbegin() + 1);
+    assert(*it == "b");
+    it = dev.erase(dev.cbegin() + 5, dev.cend());
+    assert(it == dev.end());
+    it = dev.erase(dev.cbegin(), dev.cbegin() + 2);
+    assert(*it == "c");
+    assert(dev.size() == 3 && dev.front() == "c" && dev.back() == "e");
+
+    dev.push_front(dev.back());
+    assert(dev.front() == "e");
+
+    np::devector<std::string> copy(dev);
+    dev.clear();
+    assert(dev.empty() && copy.size() == 4);
+    dev.push_front("z");
+    dev.push_back("w");
+    assert(dev.front() == "z" && dev.back() == "w");
+
+    dev = std::move(copy);
+    assert(dev.size() == 4 && dev[1] == "c");
+
+    dev.resize(6, "r");
+    assert(dev.back() == "r");
+    dev.resize(1);
+    dev.shrink_to_fit();
+    assert(dev.size() == 1 && dev.capacity() == 1 && dev.at(0) == "e");
+
+    // Inserting or emplacing one of its own elements at a full end.
+    np::devector<std::string> full{"long string one", "long string two", "long string three"};
+    full.shrink_to_fit();
+    full.insert(full.cbegin(), full[1]);
+    full.shrink_to_fit();
+    full.insert(full.cend(), full[0]);
+    full.shrink_to_fit();
+    full.emplace_front(full.back());
+    full.shrink_to_fit();
+    full.emplace_back(full.front());
+    assert(full.size() == 7);
+    const char* aliased[] = {"long string two", "long string two", "long string one", "long string two", "long string three", "long string two", "long string two"};
+    for (std::size_t i = 0; i < full.size(); ++i) {
+        assert(full[i] == aliased[i]);
+    }
+
+    full.reserve(full.size() + 4);
+    try {
+        full.insert(full.cend() + 1, "out of range");
+        assert(false);
+    }
+    catch (const std::out_of_range&) {
+    }
+}
+
+struct throws_on_copy {
+    static inline std::atomic<int> live{0};
+    static inline std::atomic<int> copies_left{0};
+
+    int value = 0;
+
+    explicit throws_on_copy(int value) : value(value) { ++live; }
+
+    throws_on_copy(const throws_on_copy& other) : value(other.value) {
+        if (--copies_left < 0) {
+            throw std::runtime_error("copy failed");
+        }
+        ++live;
+    }
+
+    ~throws_on_copy() { --live; }
+};
+
+void test_parallel_construction() {
+    const np::parallel_policy policy = np::par.with_threads(4).with_min_bytes_per_thread(4096);
+
+    np::vector<std::uint64_t> zeros(policy, 100'003);
+    assert(zeros.size() == 100'003 && zeros.capacity() == 100'003);
+    assert(std::all_of(zeros.begin(), zeros.end(), [](std::uint64_t value) { return value == 0; }));
+
+    for (np::first_touch placement : {np::first_touch::blocked, np::first_touch::interleaved}) {
+        np::vector<std::uint64_t> filled(policy.with_placement(placement), 100'003, 7);
+        assert(np::simd::sum(filled) == 7 * 100'003ULL);
+
+        filled.resize(policy.with_placement(placement), 250'000, 3);
+        assert(filled.size() == 250'000);
+        assert(filled[100'002] == 7 && filled[100'003] == 3 && filled.back() == 3);
+
+        filled.resize(policy, 10);
+        assert(filled.size() == 10 && filled.back() == 7);
+    }
+
+    np::vector<std::string> strings(policy, 5'000, std::string(40, 'x'));
+    assert(std::all_of(strings.begin(), strings.end(), [](const std::string& value) { return value.size() == 40; }));
+    strings.resize(policy, 9'000, strings[0]);
+    assert(strings.size() == 9'000 && strings.back() == std::string(40, 'x'));
+
+    np::vector<int> empty(np::par, 0);
+    assert(empty.empty() && empty.data() == nullptr);
+
+    // A failure on one worker unwinds what every worker built.
+    throws_on_copy seed(1);
+    throws_on_copy::copies_left = 20'000;
+    bool thrown = false;
+    try {
+        np::vector<throws_on_copy> failing(policy, 50'000, seed);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown && throws_on_copy::live == 1);
+
+    // Stripes start on page boundaries of the buffer, not of the element index, and cover every
+    // element exactly once; the partial page before the first boundary goes to worker 0.
+    struct element24 {
+        char bytes[24];
+    };
+    auto check_partition = [](auto element, const std::uintptr_t address, const std::size_t count, const np::first_touch placement) {
+        constexpr std::size_t size = sizeof(element);
+        const auto part = np::detail::parallel::make_partition<decltype(element)>(
+            np::par.with_threads(3).with_min_bytes_per_thread(1).with_placement(placement), count, reinterpret_cast<const void*>(address));
+
+        np::vector<int> owner(count, -1);
+        for (unsigned worker = 0; worker < part.workers; ++worker) {
+            part.for_each_range(worker, [&](const std::size_t begin, const std::size_t end) {
+                const std::uintptr_t start = address + begin * size;
+                assert(begin == 0 ? worker == 0 : (start % 4096 < size));
+                for (std::size_t i = begin; i < end; ++i) {
+                    assert(owner[i] == -1);
+                    owner[i] = static_cast<int>(worker);
+                }
+            });
+        }
+        assert(std::find(owner.begin(), owner.end(), -1) == owner.end());
+    };
+    for (np::first_touch placement : {np::first_touch::blocked, np::first_touch::interleaved}) {
+        check_partition(std::uint64_t(), 0x10010, 10'000, placement);
+        check_partition(std::uint64_t(), 0x10000, 10'000, placement);
+        check_partition(element24(), 0x20010, 3'000, placement);
+        check_partition(std::array<char, 8192>(), 0x30010, 7, placement);
+        check_partition(std::uint64_t(), 0x10010, 1, placement);
+    }
+}
+
+template <typename T>
+np::vector<T> random_keys(const std::size_t n, std::uint64_t state) {
+    np::vector<T> keys(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        if constexpr (std::is_floating_point_v<T>) {
+            keys[i] = static_cast<T>(static_cast<std::int64_t>(state) >> 11) / T(1 << 20);
+        }
+        else {
+            keys[i] = static_cast<T>(state);
+        }
+    }
+    return keys;
+}
+
+template <typename T>
+void check_sort() {
+    for (std::size_t n : {0, 1, 50, 1000, 70'000}) {
+        np::vector<T> keys = random_keys<T>(n, 0x9e3779b97f4a7c15ULL + n);
+        np::vector<T> expected(keys);
+        std::sort(expected.begin(), expected.end());
+
+        np::vector<T> parallel(keys);
+        np::sort(keys);
+        np::sort(np::par.with_threads(3).with_min_bytes_per_thread(1024), parallel);
+        assert(std::equal(keys.begin(), keys.end(), expected.begin(), expected.end()));
+        assert(std::equal(parallel.begin(), parallel.end(), expected.begin(), expected.end()));
+    }
+}
+
+void test_radix_sort() {
+    check_sort<std::uint8_t>();
+    check_sort<std::int16_t>();
+    check_sort<std::uint32_t>();
+    check_sort<std::int32_t>();
+    check_sort<std::uint64_t>();
+    check_sort<std::int64_t>();
+    check_sort<float>();
+    check_sort<double>();
+
+    // IEEE totalOrder for the special values, on both the small and the radix path.
+    for (std::size_t pad : {0, 2000}) {
+        np::vector<double> special(pad, 1.0);
+        for (double value : {std::nan(""), 0.0, -std::numeric_limits<double>::infinity(), -0.0, -1.5, -std::nan(""), 2.0}) {
+            special.push_back(value);
+        }
+        np::sort(special);
+        assert(std::isnan(special[0]) && std::signbit(special[0]));
+        assert(special[1] == -std::numeric_limits<double>::infinity() && special[2] == -1.5);
+        assert(special[3] == 0.0 && std::signbit(special[3]) && !std::signbit(special[4]));
+        assert(std::isnan(special.back()) && !std::signbit(special.back()));
+    }
+
+    np::vector<std::string> words{"pear", "apple", "fig"};
+    np::sort(words);
+    assert(words[0] == "apple" && words[2] == "pear");
+
+    // The scratch buffer is kept per thread, so sorting again allocates nothing.
+    np::vector<std::uint32_t, np::pool_allocator<std::uint32_t>> pooled;
+    for (std::uint32_t i = 0; i < 50'000; ++i) {
+        pooled.push_back(i * 2654435761u);
+    }
+    np::sort(pooled);
+    const std::uint64_t allocations = np::pool_statistics().allocations;
+    np::sort(pooled);
+    assert(np::pool_statistics().allocations == allocations);
+    assert(std::is_sorted(pooled.begin(), pooled.end()));
+
+    // release_sort_scratch() gives the cached buffer back, so the next sort allocates again.
+    const std::uint64_t cached_before = np::pool_statistics().cached_bytes;
+    np::release_sort_scratch();
+    assert(np::pool_statistics().cached_bytes > cached_before);
+    np::sort(pooled);
+    assert(np::pool_statistics().allocations == allocations + 1);
+}
+
+void test_sort_by_key() {
+    for (std::size_t n : {40, 30'000}) {
+        np::vector<std::int32_t> keys(n);
+        np::vector<std::uint32_t> values(n);
+        np::vector<std::string> names(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            keys[i] = static_cast<std::int32_t>((i * 7919) % 97) - 48;
+            values[i] = static_cast<std::uint32_t>(i);
+            names[i] = std::to_string(i);
+        }
+        np::vector<std::int32_t> keys_copy(keys);
+
+        np::sort_by_key(keys, values);
+        np::sort_by_key(np::par.with_threads(4).with_min_bytes_per_thread(1024), keys_copy, names);
+
+        assert(std::equal(keys.begin(), keys.end(), keys_copy.begin(), keys_copy.end()));
+        assert(std::is_sorted(keys.begin(), keys.end()));
+        for (std::size_t i = 0; i < n; ++i) {
+            assert(names[i] == std::to_string(values[i]));
+            // Stable: equal keys keep their original order.
+            assert(i == 0 || keys[i - 1] != keys[i] || values[i - 1] < values[i]);
+        }
+    }
+
+    // Move-only values go through the index permutation on both the small and the radix path.
+    for (std::size_t n : {10, 3'000}) {
+        np::vector<std::uint16_t> keys(n);
+        np::vector<std::unique_ptr<std::size_t>> owned;
+        for (std::size_t i = 0; i < n; ++i) {
+            keys[i] = static_cast<std::uint16_t>(n - i);
+            owned.push_back(std::make_unique<std::size_t>(n - i));
+        }
+        np::sort_by_key(keys, owned);
+        for (std::size_t i = 0; i < n; ++i) {
+            assert(*owned[i] == keys[i] && keys[i] == i + 1);
+        }
+    }
+
+    np::vector<std::string> string_keys{"b", "a", "b", "a"};
+    np::vector<int> payload{0, 1, 2, 3};
+    np::sort_by_key(string_keys, payload);
+    assert(string_keys[0] == "a" && payload[0] == 1 && payload[1] == 3 && payload[2] == 0 && payload[3] == 2);
+
+    np::vector<int> short_values{1};
+    bool thrown = false;
+    try {
+        np::sort_by_key(string_keys, short_values);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void test_shrink_policy() {
+    np::vector<std::uint64_t> vec;
+    for (std::uint64_t i = 0; i < 100'000; ++i) {
+        vec.push_back(i);
+    }
+    const std::size_t peak = vec.capacity();
+
+    vec.set_shrink_policy(np::shrink_policy{});
+    assert(vec.capacity() == peak);
+
+    while (vec.size() >= peak / 4) {
+        vec.pop_back();
+    }
+    assert(vec.capacity() == vec.size() * 2);
+    assert(vec.back() == vec.size() - 1);
+
+    // Between the thresholds nothing reallocates in either direction.
+    const std::size_t shrunk = vec.capacity();
+    for (int i = 0; i < 1000; ++i) {
+        vec.pop_back();
+    }
+    for (int i = 0; i < 2000; ++i) {
+        vec.push_back(0);
+    }
+    assert(vec.capacity() == shrunk);
+
+    auto it = vec.erase(vec.begin() + 10, vec.end() - 10);
+    assert(vec.size() == 20 && vec.capacity() == 512);
+    assert(*it == 0 && it - vec.begin() == 10 && vec[9] == 9);
+
+    vec.resize(5);
+    assert(vec.capacity() == 512 && vec[4] == 4);
+
+    // 512 elements are min_capacity_bytes, so clear() keeps them; a bigger buffer is released.
+    vec.clear();
+    assert(vec.capacity() == 512);
+    vec.reserve(10'000);
+    vec.push_back(1);
+    vec.clear();
+    assert(vec.capacity() == 0 && vec.data() == nullptr);
+
+    np::vector<std::string> strings{"a", "b", "c"};
+    bool thrown = false;
+    try {
+        strings.set_shrink_policy(np::shrink_policy{2, 2, 0});
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    strings.set_shrink_policy(np::shrink_policy{4, 2, 0});
+    strings.reserve(100);
+    strings.pop_back();
+    assert(strings.capacity() == 4 && strings.back() == "b");
+    strings.clear_shrink_policy();
+    strings.pop_back();
+    assert(strings.capacity() == 4);
+}
+
+void test_trim_registry() {
+    np::trim_registry registry;
+
+    np::vector<int> first;
+    first.reserve(1000);
+    first.push_back(1);
+    first.track(registry);
+
+    {
+        np::vector<double> second;
+        second.reserve(100);
+        second.track(registry);
+        assert(registry.size() == 2);
+    }
+    assert(registry.size() == 1);
+
+    np::vector<int> moved(std::move(first));
+    assert(registry.size() == 1);
+
+    // A request is only honoured by the member itself, on its own thread.
+    assert(!moved.trim_if_requested());
+    registry.request_trim();
+    assert(moved.capacity() == 1000);
+    assert(moved.trim_if_requested());
+    assert(moved.capacity() == 1 && moved[0] == 1);
+    assert(!moved.trim_if_requested());
+
+    // ... or on its next shrinking operation.
+    moved.reserve(500);
+    moved.push_back(2);
+    registry.request_trim();
+    moved.pop_back();
+    assert(moved.capacity() == 1 && moved[0] == 1);
+
+    // Move assignment hands over the membership as well.
+    np::vector<int> assigned;
+    assigned = std::move(moved);
+    assert(registry.size() == 1);
+    assigned.reserve(100);
+    registry.request_trim();
+    assert(!moved.trim_if_requested() && assigned.trim_if_requested());
+    assert(assigned.capacity() == 1);
+    moved = std::move(assigned);
+    assert(registry.size() == 1);
+
+    // A request from another thread doesn't touch the member's buffer.
+    moved.reserve(100);
+    std::thread([&] { registry.request_trim(); }).join();
+    assert(moved.capacity() == 100);
+    assert(moved.trim_if_requested() && moved.capacity() == 1);
+
+    moved.reserve(64);
+    np::frozen_vector<int, std::allocator<int>> frozen = std::move(moved).freeze();
+    assert(registry.size() == 0 && registry.trim() == 0);
+    assert(frozen.size() == 1);
+
+    np::vector<int> global_member(10, 3);
+    global_member.reserve(20);
+    global_member.track();
+    global_member.untrack();
+    global_member.track();
+    assert(np::trim_registry::global().trim() >= 10 * sizeof(int));
+    assert(global_member.capacity() == 10);
+}
+
+np::generator<int> count_to(int limit) {
+    for (int i = 0; i < limit; ++i) {
+        co_yield i;
+    }
+}
+
+np::generator<std::string> lines_until_failure() {
+    co_yield std::string("first");
+    co_yield std::string("second");
+    throw std::runtime_error("connection reset");
+}
+
+void test_append_from() {
+    np::vector<int> vec{-1};
+    assert(vec.append_from(count_to(1000), 512) == 1000);
+    assert(vec.size() == 1001 && vec.front() == -1 && vec.back() == 999);
+
+    np::vector<int> batched;
+    batched.append_from(count_to(3), 100);
+    assert(batched.size() == 3 && batched.capacity() == 100);
+
+    np::vector<int> sized;
+    sized.append_from(std::views::iota(0, 300));
+    assert(sized.capacity() == 300 && sized[299] == 299);
+
+    np::vector<std::string> lines;
+    bool thrown = false;
+    try {
+        lines.append_from(lines_until_failure());
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown && lines.size() == 2 && lines[1] == "second");
+
+    int seen = 0;
+    for (int value : count_to(5)) {
+        assert(value == seen++);
+    }
+    assert(seen == 5);
+}
+
+void test_chunks() {
+    np::vector<int> vec{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+    np::vector<std::size_t> sizes;
+    for (std::span<int> chunk : vec.chunks(4)) {
+        sizes.push_back(chunk.size());
+        for (int& value : chunk) {
+            value *= 2;
+        }
+    }
+    assert(sizes.size() == 3 && sizes[0] == 4 && sizes[2] == 2);
+    assert(vec[9] == 18);
+
+    const np::vector<int>& view = vec;
+    int total = 0;
+    for (std::span<const int> chunk : view.chunks(3)) {
+        total += std::accumulate(chunk.begin(), chunk.end(), 0);
+    }
+    assert(total == 90);
+
+    np::vector<int> empty;
+    for (std::span<int> chunk : empty.chunks(8)) {
+        assert(chunk.empty() && false);
+    }
+
+    bool thrown = false;
+    try {
+        vec.chunks(0);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void test_double_buffer() {
+    np::double_buffer<int> buffer(64);
+
+    std::thread producer([&] { buffer.produce(count_to(10'000)); });
+
+    long long total = 0;
+    std::size_t batches = 0;
+    np::vector<const int*> storage;
+    for (std::span<const int> batch : buffer.batches()) {
+        assert(batch.size() <= 64);
+        total += std::accumulate(batch.begin(), batch.end(), 0LL);
+        ++batches;
+        if (std::find(storage.begin(), storage.end(), batch.data()) == storage.end()) {
+            storage.push_back(batch.data());
+        }
+    }
+    producer.join();
+
+    assert(total == 9'999LL * 10'000 / 2);
+    assert(batches == (10'000 + 63) / 64);
+    // Every batch reused one of the two reserved buffers.
+    assert(storage.size() == 2);
+
+    // Abandoning the consumer generator hands its batch back to the producer.
+    np::double_buffer<int> manual(4);
+    manual.begin_fill().push_back(1);
+    manual.end_fill();
+    {
+        np::generator<std::span<const int>> consumer = manual.batches();
+        auto it = consumer.begin();
+        assert((*it).size() == 1 && (*it)[0] == 1);
+    }
+    manual.begin_fill().push_back(2);
+    manual.end_fill();
+    manual.begin_fill().push_back(3);
+    manual.end_fill();
+    manual.close();
+
+    int drained = 0;
+    for (std::span<const int> batch : manual.batches()) {
+        drained += batch[0];
+    }
+    assert(drained == 5);
+}
+
+// Hands out at most budget elements in total, through try_allocate only.
+template <typename T>
+struct budget_allocator {
+    using value_type = T;
+
+    std::size_t* budget;
+
+    explicit budget_allocator(std::size_t* budget) noexcept : budget(budget) {}
+
+    template <typename U>
+    budget_allocator(const budget_allocator<U>& other) noexcept : budget(other.budget) {}
+
+    T* allocate(std::size_t n) {
+        T* ptr = try_allocate(n);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+    T* try_allocate(std::size_t n) noexcept {
+        if (n > *budget) {
+            return nullptr;
+        }
+        *budget -= n;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept {
+        *budget += n;
+        std::allocator<T>().deallocate(ptr, n);
+    }
+
+    template <typename U>
+    bool operator==(const budget_allocator<U>& other) const noexcept {
+        return budget == other.budget;
+    }
+};
+
+void test_fallible_api() {
+    np::vector<std::string> strings;
+    assert(strings.try_reserve(4).has_value() && strings.capacity() == 4);
+    assert(strings.try_push_back("a").has_value());
+
+    auto emplaced = strings.try_emplace_back(3, 'b');
+    assert(emplaced.has_value() && **emplaced == "bbb");
+
+    auto too_big = strings.try_reserve(strings.max_size() + 1);
+    assert(!too_big && too_big.error() == np::vector_error::length_exceeded);
+    assert(strings.capacity() == 4);
+
+    strings.push_back("c");
+    const auto past_end = strings.cend();
+    strings.pop_back();
+    auto outside = strings.try_insert(past_end, "x");
+    assert(!outside && outside.error() == np::vector_error::out_of_range);
+
+    auto inserted = strings.try_insert(strings.cbegin(), "front");
+    assert(inserted && *inserted == strings.begin() && strings.size() == 3 && strings[1] == "a");
+
+    // Elements of the vector itself may be pushed or inserted while it reallocates.
+    strings.push_back(strings[2]);
+    assert(strings.size() == 4 && strings.capacity() == 4);
+    strings.push_back(strings[0]);
+    assert(strings.back() == "front" && strings[3] == "bbb");
+    strings.insert(strings.cbegin(), strings[4]);
+    assert(strings[0] == "front" && strings[1] == "front");
+    strings.emplace_back(strings[2]);
+    assert(strings.back() == "a");
+
+    std::size_t budget = 8;
+    np::vector<int, budget_allocator<int>> bounded(budget_allocator<int>{&budget});
+    assert(bounded.try_reserve(8).has_value());
+    for (int i = 0; i < 8; ++i) {
+        assert(bounded.try_push_back(i).has_value());
+    }
+    assert(bounded.capacity() == 8 && budget == 0);
+
+    auto full = bounded.try_push_back(8);
+    assert(!full && full.error() == np::vector_error::out_of_memory);
+    auto no_room = bounded.try_insert(bounded.cbegin(), -1);
+    assert(!no_room && no_room.error() == np::vector_error::out_of_memory);
+    assert(bounded.size() == 8 && bounded.front() == 0 && bounded.back() == 7);
+
+    std::size_t unlimited = std::size_t(-1);
+    np::vector<int, budget_allocator<int>> unbounded(budget_allocator<int>{&unlimited});
+    assert(unbounded.try_reserve(100).has_value() && unbounded.capacity() == 100);
+}
+
+void test_devector_allocator_move() {
+    // budget_allocator doesn't propagate on move assignment, so a devector moved into one with a
+    // different budget moves its elements and each budget gets back everything it handed out.
+    std::size_t ours = 16;
+    std::size_t theirs = 16;
+    {
+        np::devector<std::string, budget_allocator<std::string>> target(budget_allocator<std::string>{&ours});
+        target.push_back("old");
+        np::devector<std::string, budget_allocator<std::string>> source(budget_allocator<std::string>{&theirs});
+        source.push_back("b");
+        source.push_front("a");
+
+        target = std::move(source);
+        assert(target.size() == 2 && target.front() == "a" && target.back() == "b");
+        assert(source.empty() && source.capacity() == 0 && theirs == 16);
+        assert(target.get_allocator() == budget_allocator<std::string>{&ours} && ours == 14);
+
+        np::devector<std::string, budget_allocator<std::string>> same(budget_allocator<std::string>{&ours});
+        same.push_back("c");
+        const std::string* stolen = same.data();
+        target = std::move(same);
+        assert(target.size() == 1 && target.data() == stolen && same.empty());
+    }
+    assert(ours == 16 && theirs == 16);
+
+    static_assert(!std::is_nothrow_move_assignable_v<np::devector<int, budget_allocator<int>>>);
+    static_assert(std::is_nothrow_move_assignable_v<np::devector<int>>);
+}
+
+#if defined(NP_VECTOR_TRACE)
+void test_trace_recording() {
+    std::stringstream buffer;
+    np::trace::start_recording(buffer);
+    {
+        np::vector<int> vec;
+        vec.reserve(4);
+        vec.push_back(1);
+        vec.push_back(2);
+        vec.push_back(3);
+        vec.erase(vec.cbegin());
+        vec.resize(0);
+    }
+    {
+        const int values[] = {1, 2, 3};
+        np::vector<int> vec(std::begin(values), std::end(values));
+    }
+    np::trace::stop_recording();
+
+    // One event per public call: resize(0) doesn't also record a clear, and the range constructor
+    // records a single resize rather than its reserve and push_backs.
+    np::trace::reader reader(buffer);
+    np::trace::event record;
+    const np::trace::op expected[] = {np::trace::op::reserve, np::trace::op::push_back, np::trace::op::push_back, np::trace::op::push_back, np::trace::op::erase, np::trace::op::resize, np::trace::op::destroy, np::trace::op::resize, np::trace::op::destroy};
+    for (np::trace::op type : expected) {
+        assert(reader.next(record) && record.type == type);
+    }
+    assert(!reader.next(record));
+}
+#endif
+
+#if defined(NP_VECTOR_CHECKED_ITERATORS)
+void test_checked_iterators() {
+    np::vector<int> vec;
+    vec.push_back(1);
+
+    auto it = vec.begin();
+    try {
+        ++it;
+        ++it;
+        assert(false);
+    }
+    catch (const std::out_of_range&) {
+    }
+
+    // to_address() of end() is valid for a contiguous iterator, checked or not.
+    assert(std::to_address(vec.end()) == vec.data() + 1);
+    assert(std::to_address(vec.cend()) - std::to_address(vec.cbegin()) == 1);
+
+    it = vec.begin();
+    vec.reserve(100);
+    try {
+        (void)*it;
+        assert(false);
+    }
+    catch (const std::logic_error&) {
+    }
+    try {
+        (void)it.operator->();
+        assert(false);
+    }
+    catch (const std::logic_error&) {
+    }
+}
+#endif
+
 int main() {
     test_push_back_and_size();
     test_capacity_and_reserve();
@@ -161,6 +1428,39 @@ int main() {
     test_at_out_of_range();
     test_reserve_smaller_capacity();
     test_iterators();
+    test_iterator_concepts();
+    test_copy_tight_capacity();
+    test_copy_assignment_reuses_storage();
+    test_aligned_vector();
+    test_simd_kernels();
+    test_move();
+    test_freeze();
+    test_cow_vector();
+    test_atomic_frozen_vector();
+    test_packed_vector();
+    test_packed_delta_vector();
+    test_trace_roundtrip();
+    test_pool_allocator();
+    test_pool_allocator_remote_free();
+    test_pool_allocator_pending_flush();
+    test_devector_push_front();
+    test_devector_insert_erase();
+    test_parallel_construction();
+    test_radix_sort();
+    test_sort_by_key();
+    test_shrink_policy();
+    test_trim_registry();
+    test_append_from();
+    test_chunks();
+    test_double_buffer();
+    test_fallible_api();
+    test_devector_allocator_move();
+#if defined(NP_VECTOR_TRACE)
+    test_trace_recording();
+#endif
+#if defined(NP_VECTOR_CHECKED_ITERATORS)
+    test_checked_iterators();
+#endif
 
     np::vector<int> vec;
     for (int i = 0; i < 10; ++i) {